@@ -400,12 +400,32 @@ static partial class ObjCBuilderExtension
         }
         if (methodSymbol.IsNative())
         {
+            void appendInvocation()
+            {
+                builder.Append(syntax.Expression, context).Parenthesized().Append(syntax.ArgumentList.Arguments, true, context).Close();
+            }
+
+            switch (methodSymbol.ReturnType.GetFullName())
+            {
+                case "CodeBinder.cbbuffer":
+                {
+                    // Returned buffers are copied to an array box and released
+                    builder.Append("BN2OC").Parenthesized(appendInvocation);
+                    return builder;
+                }
+                case "CodeBinder.cbstringarray":
+                {
+                    builder.Append("SAN2OC").Parenthesized(appendInvocation);
+                    return builder;
+                }
+            }
+
             if (methodSymbol.ReturnType.TypeKind == TypeKind.Enum)
                 builder.Parenthesized().Append(methodSymbol.ReturnType.GetObjCName(context)).Close();
             else if (methodSymbol.ReturnType.GetFullName() == "CodeBinder.cbstring")
                 builder.Parenthesized().Append("SN2OC").Close();
 
-            builder.Append(syntax.Expression, context).Parenthesized().Append(syntax.ArgumentList.Arguments, true, context).Close();
+            appendInvocation();
         }
         else
         {
@@ -218,6 +218,12 @@ static class ObjCUtils
             case "CodeBinder.cbstring": // NOTE: We assume it's always eagerly casted to NSString
                 typeName = "NSString*";
                 return true;
+            case "CodeBinder.cbbuffer": // NOTE: Converted to an array box, see BN2OC
+                typeName = "CBUInt8Array*";
+                return true;
+            case "CodeBinder.cbstringarray": // NOTE: Converted to NSArray, see SAN2OC
+                typeName = "NSArray<NSString*>*";
+                return true;
             case "System.UIntPtr":
                 typeName = "void *";
                 return true;
@@ -339,6 +345,9 @@ static class ObjCUtils
             case "System.Double":
                 boxTypeName = "CBDoubleArray";
                 return true;
+            case "System.String":
+                boxTypeName = "NSArray<NSString*>";
+                return true;
             default:
                 boxTypeName = null;
                 return false;
@@ -8,6 +8,7 @@
 #pragma once
 
 #import "../CBOCBaseTypes.h"
+#include <CBInterop.h>
 #include <cstdint>
 #include <cinttypes>
 #import <Foundation/Foundation.h>
@@ -82,6 +83,35 @@ inline uint8_t* CBGetNativeArray(CBUInt8Array* arr)
     return arr.data;
 }
 
+// Copy the buffer to an array box, releasing it if owned
+inline CBUInt8Array* BN2OC(cbbuffer buf)
+{
+    if (buf.data == nullptr)
+        return nil;
+
+    CBUInt8Array* ret = [[CBUInt8Array alloc]initWithConstArray:(const uint8_t*)buf.data :CBBufferGetByteSize(&buf)];
+    CBFreeBuffer(&buf);
+    return ret;
+}
+
+// Convert to an array of strings, releasing it if owned
+inline NSArray<NSString*>* SAN2OC(cbstringarray arr)
+{
+    if (arr.data == nullptr)
+        return nil;
+
+    size_t count = CBStringArrayGetCount(&arr);
+    NSMutableArray<NSString*>* ret = [[NSMutableArray alloc]initWithCapacity:count];
+    for (size_t i = 0; i < count; i++)
+    {
+        cbstring str = CBStringArrayGet(&arr, i);
+        [ret addObject:[[NSString alloc]initWithBytes:str.data length:CBSLEN(str) encoding:NSUTF8StringEncoding]];
+    }
+
+    CBFreeStringArray(&arr);
+    return ret;
+}
+
 inline int8_t* CBGetNativeArray(CBInt8Array* arr)
 {
     if (arr == nil)
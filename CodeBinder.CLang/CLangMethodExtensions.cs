@@ -193,6 +193,12 @@ public static class CLangMethodExtensions
                         return "cbbool";
                     case "CodeBinder.cbstring":
                         return "cbstring";
+                    case "CodeBinder.cbbuffer":
+                        return "cbbuffer";
+                    case "CodeBinder.cbstringarray":
+                        return "cbstringarray";
+                    case "CodeBinder.cbspan":
+                        return "cbspan";
                     default:
                         throw new Exception($"Unsupported by type {fullName}");
                 }
@@ -416,6 +422,12 @@ public static class CLangMethodExtensions
             }
             case "CodeBinder.cbstring":
                 return "cbstring";
+            case "CodeBinder.cbbuffer":
+                return "cbbuffer";
+            case "CodeBinder.cbstringarray":
+                return "cbstringarray";
+            case "CodeBinder.cbspan":
+                return "cbspan";
             case "CodeBinder.cbbool":
                 return "cbbool";
             case "CodeBinder.cboptbool":
@@ -463,6 +475,12 @@ public static class CLangMethodExtensions
                 return "cbbool*";
             case "CodeBinder.cboptbool":
                 return "cboptbool*";
+            case "CodeBinder.cbbuffer":
+                return "cbbuffer*";
+            case "CodeBinder.cbstringarray":
+                return "cbstringarray*";
+            case "CodeBinder.cbspan":
+                return "cbspan*";
             case "System.Byte":
                 return "uint8_t*";
             case "System.SByte":
@@ -1,6 +1,8 @@
 ﻿// SPDX-FileCopyrightText: (C) 2020 Francesco Pretto <ceztko@gmail.com>
 // SPDX-License-Identifier: MIT
 
+using CodeBinder.Attributes;
+
 namespace CodeBinder.CLang;
 
 abstract class CLangMethodWriter : CodeWriter<MethodDeclarationSyntax, CLangModuleConversion>
@@ -123,9 +125,18 @@ class CLangMethodTrampolineWriter : CLangMethodWriter
         if (Item.ReturnType.GetTypeSymbolThrow(Context).SpecialType != SpecialType.System_Void)
             Builder.Append("return").Space();
 
+        // The handles released by [BackgroundRelease] methods are handed over
+        // to the reclamation threads, see CBReclaimer.hpp. Doing it here covers
+        // every target, including .NET which calls the C functions directly
+        if (Item.HasAttribute<BackgroundReleaseAttribute>(Context))
+            Builder.Append("cb::Reclaim<");
+
         Builder.Append(Context.Compilation.LibraryName.ToLower()).Append("::")
             .Append(Item.GetCLangMethodName());
 
+        if (Item.HasAttribute<BackgroundReleaseAttribute>(Context))
+            Builder.Append(">");
+
         using (Builder.ParameterList())
         {
             bool first = true;
@@ -52,6 +52,9 @@ public class ConversionCSharpToCLang : CSharpLanguageConversionBase<CLangCompila
             yield return new StringConversionWriter(BaseTypesHeader, () => CLangResources.CBBaseTypes_h) { GeneratedPreamble = SourcePreamble };
             yield return new StringConversionWriter("CBInterop.h", () => CLangResources.CBInterop_h) { GeneratedPreamble = SourcePreamble };
             yield return new StringConversionWriter("CBInterop.hpp", () => CLangResources.CBInterop_hpp) { GeneratedPreamble = SourcePreamble };
+            yield return new StringConversionWriter("CBUnicode.hpp", () => CLangResources.CBUnicode_hpp) { GeneratedPreamble = SourcePreamble };
+            yield return new StringConversionWriter("CBTrampolineStats.hpp", () => CLangResources.CBTrampolineStats_hpp) { GeneratedPreamble = SourcePreamble };
+            yield return new StringConversionWriter("CBReclaimer.hpp", () => CLangResources.CBReclaimer_hpp) { GeneratedPreamble = SourcePreamble };
         }
     }
 }
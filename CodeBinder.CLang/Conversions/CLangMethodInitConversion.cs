@@ -13,6 +13,55 @@ class CLangMethodInitConversion : CLangConversionWriter
         foreach (var module in Compilation.Modules)
             builder.Append("#include \"").Append(module.Name).AppendLine(".h\"");
 
+        builder.AppendLine("#include \"CBInterop.h\"");
+        builder.AppendLine("#include \"CBReclaimer.hpp\"");
+        builder.AppendLine();
+
+        // Allocator entry points, so hosts that free native memory on
+        // their side of the boundary (eg. .NET) can use the same allocator
+        // and release adopted or shared strings
+        string LIBRARY_SHARED_API = $"{Compilation.LibraryName.ToUpper()}_SHARED_API";
+        builder.AppendLine("extern \"C\"");
+        using (builder.Block())
+        {
+            builder.AppendLine($$"""
+{{LIBRARY_SHARED_API}} void* CB_AllocMemory(size_t size)
+{
+    return CBAllocMemory(size);
+}
+
+{{LIBRARY_SHARED_API}} void CB_FreeMemory(void* ptr)
+{
+    CBFreeMemory(ptr);
+}
+
+{{LIBRARY_SHARED_API}} void CB_FreeString(cbstring* str)
+{
+    CBFreeString(str);
+}
+
+// Snapshot of the background reclamation queue, see CBReclaimer.hpp
+{{LIBRARY_SHARED_API}} void CB_GetReclaimerStats(CBReclaimerStats* stats)
+{
+    cb::GetReclaimerStats(*stats);
+}
+
+// Mark the calling thread as a finalizer thread, which never stalls
+// releasing [BackgroundRelease] handles
+{{LIBRARY_SHARED_API}} void CB_SetReclaimerFinalizerThread()
+{
+    cb::SetReclaimerFinalizerThread();
+}
+
+// Release the queued handles and join the reclamation threads. Call
+// it before unloading the library on Windows, see CBReclaimer.hpp
+{{LIBRARY_SHARED_API}} void CB_ShutdownReclaimer()
+{
+    cb::ShutdownReclaimer();
+}
+""");
+        }
+
         builder.AppendLine();
         builder.AppendLine("// Reference this symbol to ensure all functions are defined");
         builder.AppendLine("// See https://github.com/dotnet/samples/tree/3870722f5c5e80fd6a70946e6e96a5c990620e42/core/nativeaot/NativeLibrary#user-content-building-static-libraries");
@@ -24,6 +73,13 @@ class CLangMethodInitConversion : CLangConversionWriter
                 foreach (var method in module.Methods)
                     builder.Append("(void *)").Append(method.GetCLangMethodName()).AppendLine(",");
             }
+
+            builder.AppendLine("(void *)CB_AllocMemory,");
+            builder.AppendLine("(void *)CB_FreeMemory,");
+            builder.AppendLine("(void *)CB_FreeString,");
+            builder.AppendLine("(void *)CB_GetReclaimerStats,");
+            builder.AppendLine("(void *)CB_SetReclaimerFinalizerThread,");
+            builder.AppendLine("(void *)CB_ShutdownReclaimer,");
         }
 
         builder.Append("}").EndOfStatement();
@@ -44,10 +44,57 @@ typedef struct
     cbbool value;
 } cboptbool;
 
+typedef enum
+{
+    CB_ELEMENT_UINT8 = 0,
+    CB_ELEMENT_INT8,
+    CB_ELEMENT_UINT16,
+    CB_ELEMENT_INT16,
+    CB_ELEMENT_UINT32,
+    CB_ELEMENT_INT32,
+    CB_ELEMENT_UINT64,
+    CB_ELEMENT_INT64,
+    CB_ELEMENT_FLOAT,
+    CB_ELEMENT_DOUBLE,
+} CBElementKind;
+
+// Length carrying buffer. Like cbstring, opaque stores the element
+// count and the ownership flag, see CBInterop.h
+typedef struct
+{
+    void* data;
+    uintptr_t opaque;
+    int32_t kind;
+} cbbuffer;
+
+// Packed string array. data points to a single block holding the
+// offsets table followed by the null terminated UTF-8 strings, and
+// opaque stores the string count and the ownership flag
+typedef struct
+{
+    void* data;
+    uintptr_t opaque;
+} cbstringarray;
+
+// Byte view of native memory, that can be shared without copying
+// when the target supports it (eg. Java direct ByteBuffer). opaque
+// stores the byte size and the ownership flag, see CBInterop.h
+typedef struct
+{
+    void* data;
+    uintptr_t opaque;
+} cbspan;
+
 #ifdef __cplusplus
 #define cbstringnull cbstring{ }
+#define cbbuffernull cbbuffer{ }
+#define cbstringarraynull cbstringarray{ }
+#define cbspannull cbspan{ }
 #else // __cplusplus
 #define cbstringnull (const cbstring){ NULL, 0 }
+#define cbbuffernull (const cbbuffer){ NULL, 0, 0 }
+#define cbstringarraynull (const cbstringarray){ NULL, 0 }
+#define cbspannull (const cbspan){ NULL, 0 }
 #endif // __cplusplus
 
 #endif // CODE_BINDER_BASE_TYPES
@@ -11,19 +11,45 @@
 
 #ifdef __cplusplus
 #include <cstring>
+#include <cassert>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <string_view>
+#include <new>
 #else // __cplusplus
 #include <string.h>
+#include <assert.h>
 #endif // __cplusplus
 
+// CB_STRING_ARENA_FLAG marks data living in the thread-local scratch
+// arena, which is recycled when the current trampoline call exits.
+// CB_STRING_EXTERNAL_FLAG marks adopted buffers that are given back
+// to their owner through a release callback. CB_STRING_SHARED_FLAG
+// marks data preceded by a CBSharedStringHeader: without
+// CB_STRING_OWNSDATA_FLAG the string is interned and never released
 #if UINTPTR_MAX == UINT32_MAX
 #define CB_STRING_OWNSDATA_FLAG (1u << 31)
+#define CB_STRING_ARENA_FLAG (1u << 30)
+#define CB_STRING_EXTERNAL_FLAG (1u << 29)
+#define CB_STRING_SHARED_FLAG (1u << 28)
 #elif UINTPTR_MAX == UINT64_MAX
 #define CB_STRING_OWNSDATA_FLAG (1ull << 63)
+#define CB_STRING_ARENA_FLAG (1ull << 62)
+#define CB_STRING_EXTERNAL_FLAG (1ull << 61)
+#define CB_STRING_SHARED_FLAG (1ull << 60)
 #else
 #error "Environment not 32 or 64-bit."
 #endif
 
-#define CBSLEN(str) (size_t)((str).opaque & ~CB_STRING_OWNSDATA_FLAG)
+#define CB_STRING_FLAGS_MASK (CB_STRING_OWNSDATA_FLAG | CB_STRING_ARENA_FLAG | CB_STRING_EXTERNAL_FLAG | CB_STRING_SHARED_FLAG)
+#define CBSLEN(str) (size_t)((str).opaque & ~CB_STRING_FLAGS_MASK)
+
+// Buffers share the ownership bit with strings
+#define CB_BUFFER_OWNSDATA_FLAG CB_STRING_OWNSDATA_FLAG
+#define CBBLEN(buf) (size_t)((buf).opaque & ~CB_BUFFER_OWNSDATA_FLAG)
+#define CBSACOUNT(arr) (size_t)((arr).opaque & ~CB_STRING_OWNSDATA_FLAG)
+#define CBSPLEN(span) (size_t)((span).opaque & ~CB_BUFFER_OWNSDATA_FLAG)
 
 #ifdef __cplusplus
 extern "C"
@@ -35,8 +61,32 @@ extern "C"
     __declspec(dllimport) void* __stdcall LocalAlloc(unsigned int uFlags, size_t uBytes);
 #endif // WIN32
 
-    inline void* CBAllocMemory(size_t size)
+    /// <summary>
+    /// Allocator used for all memory handed across the binding boundary,
+    /// most notably owned cbstring data
+    /// </summary>
+    typedef struct
+    {
+        void* (*alloc)(void* userdata, size_t size);
+        void (*free)(void* userdata, void* ptr);
+        void* userdata;
+        const char* name;
+    } CBAllocator;
+
+    /// <summary>
+    /// Snapshot of the counters of the current allocator
+    /// </summary>
+    typedef struct
     {
+        uint64_t alloc_count;
+        uint64_t free_count;
+        uint64_t alloc_bytes;
+        uint64_t failed_count;
+    } CBAllocatorStats;
+
+    inline void* CBDefaultAlloc(void* userdata, size_t size)
+    {
+        (void)userdata;
 #ifdef WIN32
 #ifndef LMEM_FIXED
         const unsigned int LMEM_FIXED = 0x0000;
@@ -47,8 +97,9 @@ extern "C"
 #endif
     }
 
-    inline void CBFreeMemory(void* ptr)
+    inline void CBDefaultFree(void* userdata, void* ptr)
     {
+        (void)userdata;
 #ifdef WIN32
         LocalFree(ptr);
 #else
@@ -56,6 +107,99 @@ extern "C"
 #endif
     }
 
+#ifdef __cplusplus
+#define CB_ALLOCATOR_COUNTER std::atomic<uint64_t>
+#define CB_ALLOCATOR_COUNTER_ADD(counter, value) (counter).fetch_add(value, std::memory_order_relaxed)
+#define CB_ALLOCATOR_COUNTER_LOAD(counter) (counter).load(std::memory_order_relaxed)
+#define CB_ALLOCATOR_COUNTER_STORE(counter, value) (counter).store(value, std::memory_order_relaxed)
+#else // __cplusplus
+#define CB_ALLOCATOR_COUNTER uint64_t
+#define CB_ALLOCATOR_COUNTER_ADD(counter, value) ((counter) += (value))
+#define CB_ALLOCATOR_COUNTER_LOAD(counter) (counter)
+#define CB_ALLOCATOR_COUNTER_STORE(counter, value) ((counter) = (value))
+#endif // __cplusplus
+
+    typedef struct
+    {
+        CBAllocator allocator;
+        CB_ALLOCATOR_COUNTER alloc_count;
+        CB_ALLOCATOR_COUNTER free_count;
+        CB_ALLOCATOR_COUNTER alloc_bytes;
+        CB_ALLOCATOR_COUNTER failed_count;
+    } CBAllocatorState;
+
+    // NOTE: The state is shared by all the translation units of a module
+    inline CBAllocatorState* CBGetAllocatorState()
+    {
+        static CBAllocatorState s_state = { { CBDefaultAlloc, CBDefaultFree, NULL, "default" }, 0, 0, 0, 0 };
+        return &s_state;
+    }
+
+    /// <summary>
+    /// Replace the allocator and reset the counters. Passing NULL restores
+    /// the default allocator. It must be called before any memory is
+    /// allocated, since memory is always released with the current allocator
+    /// </summary>
+    inline void CBSetAllocator(const CBAllocator* allocator)
+    {
+        CBAllocatorState* state = CBGetAllocatorState();
+        if (allocator == NULL)
+        {
+            CBAllocator defaultAllocator = { CBDefaultAlloc, CBDefaultFree, NULL, "default" };
+            state->allocator = defaultAllocator;
+        }
+        else
+        {
+            state->allocator = *allocator;
+        }
+
+        CB_ALLOCATOR_COUNTER_STORE(state->alloc_count, 0);
+        CB_ALLOCATOR_COUNTER_STORE(state->free_count, 0);
+        CB_ALLOCATOR_COUNTER_STORE(state->alloc_bytes, 0);
+        CB_ALLOCATOR_COUNTER_STORE(state->failed_count, 0);
+    }
+
+    inline const CBAllocator* CBGetAllocator()
+    {
+        return &CBGetAllocatorState()->allocator;
+    }
+
+    inline void CBGetAllocatorStats(CBAllocatorStats* stats)
+    {
+        CBAllocatorState* state = CBGetAllocatorState();
+        stats->alloc_count = CB_ALLOCATOR_COUNTER_LOAD(state->alloc_count);
+        stats->free_count = CB_ALLOCATOR_COUNTER_LOAD(state->free_count);
+        stats->alloc_bytes = CB_ALLOCATOR_COUNTER_LOAD(state->alloc_bytes);
+        stats->failed_count = CB_ALLOCATOR_COUNTER_LOAD(state->failed_count);
+    }
+
+    inline void* CBAllocMemory(size_t size)
+    {
+        CBAllocatorState* state = CBGetAllocatorState();
+        void* ret = state->allocator.alloc(state->allocator.userdata, size);
+        if (ret == NULL)
+        {
+            CB_ALLOCATOR_COUNTER_ADD(state->failed_count, 1);
+        }
+        else
+        {
+            CB_ALLOCATOR_COUNTER_ADD(state->alloc_count, 1);
+            CB_ALLOCATOR_COUNTER_ADD(state->alloc_bytes, (uint64_t)size);
+        }
+
+        return ret;
+    }
+
+    inline void CBFreeMemory(void* ptr)
+    {
+        if (ptr == NULL)
+            return;
+
+        CBAllocatorState* state = CBGetAllocatorState();
+        CB_ALLOCATOR_COUNTER_ADD(state->free_count, 1);
+        state->allocator.free(state->allocator.userdata, ptr);
+    }
+
     inline size_t CBStringGetLength(const cbstring* str)
     {
         return CBSLEN(*str);
@@ -72,7 +216,7 @@ extern "C"
         }
         else
         {
-            cbstring ret = { newstr, len };
+            cbstring ret = { newstr, len | CB_STRING_OWNSDATA_FLAG };
             memcpy(newstr, str, len);
             newstr[len] = '\0';
             return ret;
@@ -89,7 +233,7 @@ extern "C"
         }
         else
         {
-            cbstring ret = { newstr, len };
+            cbstring ret = { newstr, len | CB_STRING_OWNSDATA_FLAG };
             memcpy(newstr, str, len);
             newstr[len] = '\0';
             return ret;
@@ -106,7 +250,7 @@ extern "C"
         }
         else
         {
-            cbstring ret = { newstr, len };
+            cbstring ret = { newstr, len | CB_STRING_OWNSDATA_FLAG };
             newstr[0] = '\0';
             return ret;
         }
@@ -124,15 +268,503 @@ extern "C"
         return ret;
     }
 
+    /// <summary>
+    /// Growable buffer used to build strings incrementally. Memory comes
+    /// from the current allocator, so the result of CBStringBuilderFinish
+    /// is handed over as an owned cbstring without a final copy
+    /// </summary>
+    typedef struct
+    {
+        char* data;
+        size_t length;
+        size_t capacity;
+    } CBStringBuilder;
+
+    inline void CBStringBuilderInit(CBStringBuilder* builder)
+    {
+        builder->data = NULL;
+        builder->length = 0;
+        builder->capacity = 0;
+    }
+
+    /// <summary>
+    /// Ensure room for at least capacity chars, plus the terminator
+    /// </summary>
+    inline cbbool CBStringBuilderReserve(CBStringBuilder* builder, size_t capacity)
+    {
+        if (capacity <= builder->capacity)
+            return (cbbool)1;
+
+        // Grow geometrically to make appends amortized O(1)
+        size_t newcapacity = builder->capacity < 16 ? 16 : builder->capacity;
+        while (newcapacity < capacity)
+        {
+            if (newcapacity > (SIZE_MAX - 1) / 2)
+            {
+                newcapacity = capacity;
+                break;
+            }
+
+            newcapacity *= 2;
+        }
+
+        if (newcapacity == SIZE_MAX)
+            return (cbbool)0;
+
+        char* newdata = (char*)CBAllocMemory(newcapacity + 1);
+        if (newdata == NULL)
+            return (cbbool)0;
+
+        if (builder->length != 0)
+            memcpy(newdata, builder->data, builder->length);
+
+        CBFreeMemory(builder->data);
+        builder->data = newdata;
+        builder->capacity = newcapacity;
+        return (cbbool)1;
+    }
+
+    inline cbbool CBStringBuilderAppendLen(CBStringBuilder* builder, const char* str, size_t len)
+    {
+        if (len > SIZE_MAX - 1 - builder->length)
+            return (cbbool)0;
+
+        if (!CBStringBuilderReserve(builder, builder->length + len))
+            return (cbbool)0;
+
+        if (len != 0)
+            memcpy(builder->data + builder->length, str, len);
+
+        builder->length += len;
+        return (cbbool)1;
+    }
+
+    inline cbbool CBStringBuilderAppend(CBStringBuilder* builder, const char* str)
+    {
+        return CBStringBuilderAppendLen(builder, str, strlen(str));
+    }
+
+    inline cbbool CBStringBuilderAppendChar(CBStringBuilder* builder, char ch)
+    {
+        return CBStringBuilderAppendLen(builder, &ch, 1);
+    }
+
+    /// <summary>
+    /// Hand the buffer over as an owned cbstring and reset the builder.
+    /// Returns a null string if the allocation failed
+    /// </summary>
+    inline cbstring CBStringBuilderFinish(CBStringBuilder* builder)
+    {
+        if (builder->data == NULL)
+            return CBCreateStringFixed(0);
+
+        builder->data[builder->length] = '\0';
+        cbstring ret = { builder->data, builder->length | CB_STRING_OWNSDATA_FLAG };
+        CBStringBuilderInit(builder);
+        return ret;
+    }
+
+    inline void CBStringBuilderFree(CBStringBuilder* builder)
+    {
+        CBFreeMemory(builder->data);
+        CBStringBuilderInit(builder);
+    }
+
+    typedef void (*CBStringReleaseCallback)(void* context, const char* data, size_t len);
+
+#ifdef __cplusplus
+    typedef struct
+    {
+        CBStringReleaseCallback release;
+        void* context;
+    } CBStringReleaser;
+
+#ifndef CB_EXTERNAL_STRINGS_SHARDS
+#define CB_EXTERNAL_STRINGS_SHARDS 16
+#endif // CB_EXTERNAL_STRINGS_SHARDS
+
+    typedef struct
+    {
+        std::mutex mutex;
+        std::unordered_map<const char*, CBStringReleaser> releasers;
+    } CBExternalStringsShard;
+
+    // Adopted buffers keep their data pointer, so the releaser can't be
+    // stored in front of the data like shared strings do: it's looked up
+    // by data pointer in a table sharded to limit the lock contention.
+    // NOTE: The table is shared by all the translation units of a module,
+    // so external strings must be released by the module that created
+    // them. Hosts do so through the generated CB_FreeString export
+    inline CBExternalStringsShard* CBGetExternalStringsShard(const char* data)
+    {
+        static CBExternalStringsShard s_shards[CB_EXTERNAL_STRINGS_SHARDS];
+        // Discard the low bits, which are mostly the same because of alignment
+        return &s_shards[((uintptr_t)data >> 4) % CB_EXTERNAL_STRINGS_SHARDS];
+    }
+
+    /// <summary>
+    /// Adopt an existing buffer without copying it. The release callback
+    /// is invoked with the given context by whichever side frees the
+    /// string. The buffer doesn't need to be null terminated. If the
+    /// buffer is already adopted by a live string it's copied instead
+    /// and released immediately, so each release callback is always
+    /// invoked with its own context
+    /// </summary>
+    inline cbstring CBCreateStringExternal(const char* data, size_t len,
+        CBStringReleaseCallback release, void* context)
+    {
+        CBExternalStringsShard* shard = CBGetExternalStringsShard(data);
+        bool inserted;
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            inserted = shard->releasers.insert({ data, CBStringReleaser{ release, context } }).second;
+        }
+
+        if (!inserted)
+        {
+            cbstring ret = CBCreateStringLen(data, len);
+            release(context, data, len);
+            return ret;
+        }
+
+        cbstring ret = { data, len | CB_STRING_OWNSDATA_FLAG | CB_STRING_EXTERNAL_FLAG };
+        return ret;
+    }
+
+    inline void CBReleaseExternalString(const cbstring* str)
+    {
+        CBStringReleaser releaser;
+        CBExternalStringsShard* shard = CBGetExternalStringsShard(str->data);
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            auto found = shard->releasers.find(str->data);
+            if (found == shard->releasers.end())
+            {
+                // Released by a module that didn't create it
+                assert(false && "Unknown external string");
+                return;
+            }
+
+            releaser = found->second;
+            shard->releasers.erase(found);
+        }
+
+        releaser.release(releaser.context, str->data, CBSLEN(*str));
+    }
+
+    typedef struct
+    {
+        std::atomic<size_t> refcount;
+        size_t length;
+    } CBSharedStringHeader;
+
+    inline CBSharedStringHeader* CBGetSharedStringHeader(const cbstring* str)
+    {
+        return (CBSharedStringHeader*)str->data - 1;
+    }
+
+    inline cbstring CBCreateSharedString(const char* str, size_t len, uintptr_t flags)
+    {
+        void* mem = CBAllocMemory(sizeof(CBSharedStringHeader) + len + 1);
+        if (mem == NULL)
+            return cbstringnull;
+
+        CBSharedStringHeader* header = new (mem) CBSharedStringHeader;
+        header->refcount.store(1, std::memory_order_relaxed);
+        header->length = len;
+        char* data = (char*)(header + 1);
+        memcpy(data, str, len);
+        data[len] = '\0';
+        cbstring ret = { data, len | CB_STRING_SHARED_FLAG | flags };
+        return ret;
+    }
+
+    /// <summary>
+    /// Create a reference counted string. Use CBStringRetain to share it
+    /// and CBFreeString to release each reference
+    /// </summary>
+    inline cbstring CBCreateStringShared(const char* str, size_t len)
+    {
+        return CBCreateSharedString(str, len, CB_STRING_OWNSDATA_FLAG);
+    }
+
+    /// <summary>
+    /// Return a new reference to the string: shared strings are
+    /// reference counted, interned strings are returned as they are
+    /// and other strings are copied
+    /// </summary>
+    inline cbstring CBStringRetain(const cbstring* str)
+    {
+        if ((str->opaque & CB_STRING_SHARED_FLAG) == 0)
+        {
+            if (str->data == NULL)
+                return cbstringnull;
+
+            return CBCreateStringLen(str->data, CBSLEN(*str));
+        }
+
+        if ((str->opaque & CB_STRING_OWNSDATA_FLAG) != 0)
+            CBGetSharedStringHeader(str)->refcount.fetch_add(1, std::memory_order_relaxed);
+
+        return *str;
+    }
+
+    inline void CBReleaseSharedString(const cbstring* str)
+    {
+        CBSharedStringHeader* header = CBGetSharedStringHeader(str);
+        if (header->refcount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            header->~CBSharedStringHeader();
+            CBFreeMemory(header);
+        }
+    }
+
+    inline cbbool CBStringIsInterned(const cbstring* str)
+    {
+        return (str->opaque & (CB_STRING_SHARED_FLAG | CB_STRING_OWNSDATA_FLAG)) == CB_STRING_SHARED_FLAG;
+    }
+
+    typedef struct
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string_view, cbstring> strings;
+    } CBInternedStrings;
+
+    // NOTE: The table is shared by all the translation units of a module
+    inline CBInternedStrings* CBGetInternedStrings()
+    {
+        static CBInternedStrings s_strings;
+        return &s_strings;
+    }
+
+    /// <summary>
+    /// Return the unique interned copy of the string. Interned strings
+    /// are never released, so hosts can cache their converted
+    /// counterparts by data pointer
+    /// </summary>
+    inline cbstring CBInternStringLen(const char* str, size_t len)
+    {
+        CBInternedStrings* strings = CBGetInternedStrings();
+        std::lock_guard<std::mutex> lock(strings->mutex);
+        auto found = strings->strings.find(std::string_view(str, len));
+        if (found != strings->strings.end())
+            return found->second;
+
+        cbstring ret = CBCreateSharedString(str, len, 0);
+        if (ret.data != NULL)
+            strings->strings.insert({ std::string_view(ret.data, len), ret });
+
+        return ret;
+    }
+
+    inline cbstring CBInternString(const char* str)
+    {
+        return CBInternStringLen(str, strlen(str));
+    }
+#endif // __cplusplus
+
     inline void CBFreeString(cbstring* str)
     {
         if ((str->opaque & CB_STRING_OWNSDATA_FLAG) != 0)
         {
-            CBFreeMemory((char*)str->data);
+#ifdef __cplusplus
+            if ((str->opaque & CB_STRING_EXTERNAL_FLAG) != 0)
+                CBReleaseExternalString(str);
+            else if ((str->opaque & CB_STRING_SHARED_FLAG) != 0)
+                CBReleaseSharedString(str);
+            else
+#endif // __cplusplus
+                CBFreeMemory((char*)str->data);
+
             *str = cbstringnull;
         }
     }
 
+    inline size_t CBElementSize(int32_t kind)
+    {
+        switch (kind)
+        {
+            case CB_ELEMENT_UINT8:
+            case CB_ELEMENT_INT8:
+                return 1;
+            case CB_ELEMENT_UINT16:
+            case CB_ELEMENT_INT16:
+                return 2;
+            case CB_ELEMENT_UINT32:
+            case CB_ELEMENT_INT32:
+            case CB_ELEMENT_FLOAT:
+                return 4;
+            case CB_ELEMENT_UINT64:
+            case CB_ELEMENT_INT64:
+            case CB_ELEMENT_DOUBLE:
+                return 8;
+            default:
+                return 0;
+        }
+    }
+
+    inline size_t CBBufferGetLength(const cbbuffer* buf)
+    {
+        return CBBLEN(*buf);
+    }
+
+    inline size_t CBBufferGetByteSize(const cbbuffer* buf)
+    {
+        return CBBLEN(*buf) * CBElementSize(buf->kind);
+    }
+
+    /// <summary>
+    /// Create an uninitialized buffer of the given element count,
+    /// owned by the receiver. Returns cbbuffernull on an unknown element
+    /// kind or if the byte size overflows
+    /// </summary>
+    inline cbbuffer CBCreateBuffer(int32_t kind, size_t length)
+    {
+        size_t elemSize = CBElementSize(kind);
+        assert(elemSize != 0 && "Unknown buffer element kind");
+        if (elemSize == 0)
+            return cbbuffernull;
+
+        // The length shares its storage with the ownership flag
+        if (length > (SIZE_MAX & ~CB_BUFFER_OWNSDATA_FLAG) / elemSize)
+            return cbbuffernull;
+
+        size_t size = length * elemSize;
+        // Always allocate, so empty buffers are distinguished from null
+        void* data = CBAllocMemory(size == 0 ? 1 : size);
+        if (data == NULL)
+            return cbbuffernull;
+
+        cbbuffer ret = { data, length | CB_BUFFER_OWNSDATA_FLAG, kind };
+        return ret;
+    }
+
+    inline cbbuffer CBCreateBufferCopy(const void* data, int32_t kind, size_t length)
+    {
+        cbbuffer ret = CBCreateBuffer(kind, length);
+        if (ret.data != NULL && length != 0)
+            memcpy(ret.data, data, length * CBElementSize(kind));
+
+        return ret;
+    }
+
+    inline cbbuffer CBCreateBufferView(void* data, int32_t kind, size_t length)
+    {
+        cbbuffer ret = { data, length, kind };
+        return ret;
+    }
+
+    inline void CBFreeBuffer(cbbuffer* buf)
+    {
+        if ((buf->opaque & CB_BUFFER_OWNSDATA_FLAG) != 0)
+        {
+            CBFreeMemory(buf->data);
+            *buf = cbbuffernull;
+        }
+    }
+
+    /// <summary>
+    /// Create an uninitialized span of the given byte size, owned by the
+    /// receiver, which will release it with CBFreeMemory
+    /// </summary>
+    inline cbspan CBCreateSpan(size_t size)
+    {
+        // Always allocate, so empty spans are distinguished from null
+        void* data = CBAllocMemory(size == 0 ? 1 : size);
+        if (data == NULL)
+            return cbspannull;
+
+        cbspan ret = { data, size | CB_BUFFER_OWNSDATA_FLAG };
+        return ret;
+    }
+
+    inline cbspan CBCreateSpanView(void* data, size_t size)
+    {
+        cbspan ret = { data, size };
+        return ret;
+    }
+
+    inline void CBFreeSpan(cbspan* span)
+    {
+        if ((span->opaque & CB_BUFFER_OWNSDATA_FLAG) != 0)
+        {
+            CBFreeMemory(span->data);
+            *span = cbspannull;
+        }
+    }
+
+    inline size_t CBStringArrayGetCount(const cbstringarray* arr)
+    {
+        return CBSACOUNT(*arr);
+    }
+
+    /// <summary>
+    /// Get a non owning view of the string at the given index
+    /// </summary>
+    inline cbstring CBStringArrayGet(const cbstringarray* arr, size_t index)
+    {
+        const size_t* offsets = (const size_t*)arr->data;
+        const char* chars = (const char*)(offsets + CBSACOUNT(*arr) + 1);
+        // Lengths exclude the null terminator of each string
+        cbstring ret = { chars + offsets[index], offsets[index + 1] - offsets[index] - 1 };
+        return ret;
+    }
+
+    /// <summary>
+    /// Allocate an uninitialized string array, sized for the given count
+    /// and total length of the strings, excluding terminators
+    /// </summary>
+    inline cbstringarray CBCreateStringArrayFixed(size_t count, size_t totalLength)
+    {
+        size_t* offsets = (size_t*)CBAllocMemory((count + 1) * sizeof(size_t) + totalLength + count);
+        if (offsets == NULL)
+            return cbstringarraynull;
+
+        offsets[0] = 0;
+        cbstringarray ret = { offsets, count | CB_STRING_OWNSDATA_FLAG };
+        return ret;
+    }
+
+    /// <summary>
+    /// Set the string at the given index. Strings must be set in order
+    /// </summary>
+    inline void CBStringArraySet(cbstringarray* arr, size_t index, const char* str, size_t len)
+    {
+        size_t* offsets = (size_t*)arr->data;
+        char* chars = (char*)(offsets + CBSACOUNT(*arr) + 1);
+        char* dst = chars + offsets[index];
+        if (len != 0)
+            memcpy(dst, str, len);
+
+        dst[len] = '\0';
+        offsets[index + 1] = offsets[index] + len + 1;
+    }
+
+    inline cbstringarray CBCreateStringArray(const cbstring* strings, size_t count)
+    {
+        size_t totalLength = 0;
+        for (size_t i = 0; i < count; i++)
+            totalLength += CBSLEN(strings[i]);
+
+        cbstringarray ret = CBCreateStringArrayFixed(count, totalLength);
+        if (ret.data == NULL)
+            return ret;
+
+        for (size_t i = 0; i < count; i++)
+            CBStringArraySet(&ret, i, strings[i].data, CBSLEN(strings[i]));
+
+        return ret;
+    }
+
+    inline void CBFreeStringArray(cbstringarray* arr)
+    {
+        if ((arr->opaque & CB_STRING_OWNSDATA_FLAG) != 0)
+        {
+            CBFreeMemory(arr->data);
+            *arr = cbstringarraynull;
+        }
+    }
+
     inline cboptbool CBCreateOptBool(cbbool value)
     {
         return cboptbool{ (cbbool)true, value };
@@ -14,6 +14,9 @@
 #include <utility>
 #include <new>
 #include <stdexcept>
+#include <cstddef>
+#include "CBTrampolineStats.hpp"
+#include "CBReclaimer.hpp"
 
 namespace cb
 {
@@ -40,6 +43,288 @@ namespace cb
     {
         CBFreeMemory(ptr);
     }
+
+    /// <summary>
+    /// Thread-local bump allocator for data that lives as long as a
+    /// single trampoline call. Allocations are served only while a
+    /// ScratchScope is active and are recycled all at once when the
+    /// outermost scope of the thread exits
+    /// </summary>
+    class ScratchArena final
+    {
+        friend class ScratchScope;
+
+        struct Chunk
+        {
+            Chunk* next;
+            size_t capacity;
+            size_t used;
+        };
+
+    public:
+        static constexpr size_t ChunkSize = 16384;
+
+        ScratchArena(const ScratchArena&) = delete;
+        ScratchArena& operator=(const ScratchArena&) = delete;
+
+        /// <summary>
+        /// Allocate memory from the arena of the current thread.
+        /// Returns nullptr if no ScratchScope is active
+        /// </summary>
+        static void* Alloc(size_t size)
+        {
+            auto& arena = instance();
+            if (arena.m_depth == 0)
+                return nullptr;
+
+            return arena.alloc(size);
+        }
+
+        static bool IsActive()
+        {
+            return instance().m_depth != 0;
+        }
+
+    private:
+        ScratchArena()
+            : m_head(nullptr), m_current(nullptr), m_depth(0) { }
+
+        ~ScratchArena()
+        {
+            auto chunk = m_head;
+            while (chunk != nullptr)
+            {
+                auto next = chunk->next;
+                FreeMemory(chunk);
+                chunk = next;
+            }
+        }
+
+        static ScratchArena& instance()
+        {
+            static thread_local ScratchArena s_arena;
+            return s_arena;
+        }
+
+        void* alloc(size_t size)
+        {
+            constexpr size_t alignment = alignof(std::max_align_t);
+            size = (size + alignment - 1) & ~(alignment - 1);
+            if (m_current == nullptr || m_current->capacity - m_current->used < size)
+            {
+                // Oversized requests get a dedicated chunk, released on reset
+                size_t capacity = size > ChunkSize ? size : ChunkSize;
+                auto chunk = (Chunk*)AllocMemory(headerSize() + capacity);
+                chunk->next = nullptr;
+                chunk->capacity = capacity;
+                chunk->used = 0;
+                if (m_current == nullptr)
+                    m_head = chunk;
+                else
+                    m_current->next = chunk;
+
+                m_current = chunk;
+            }
+
+            auto ret = (char*)m_current + headerSize() + m_current->used;
+            m_current->used += size;
+            return ret;
+        }
+
+        void enter()
+        {
+            m_depth++;
+        }
+
+        void leave()
+        {
+            m_depth--;
+            if (m_depth != 0 || m_head == nullptr)
+                return;
+
+            // Keep the first chunk around for the next call
+            auto chunk = m_head->next;
+            while (chunk != nullptr)
+            {
+                auto next = chunk->next;
+                FreeMemory(chunk);
+                chunk = next;
+            }
+
+            m_head->next = nullptr;
+            m_head->used = 0;
+            m_current = m_head;
+        }
+
+        static constexpr size_t headerSize()
+        {
+            return (sizeof(Chunk) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        }
+
+    private:
+        Chunk* m_head;
+        Chunk* m_current;
+        unsigned m_depth;
+    };
+
+    /// <summary>
+    /// Activate the scratch arena of the current thread for the
+    /// lifetime of the object. Scopes can be nested
+    /// </summary>
+    class ScratchScope final
+    {
+    public:
+        ScratchScope()
+        {
+            ScratchArena::instance().enter();
+        }
+
+        ~ScratchScope()
+        {
+            ScratchArena::instance().leave();
+        }
+
+        ScratchScope(const ScratchScope&) = delete;
+        ScratchScope& operator=(const ScratchScope&) = delete;
+    };
+
+    /// <summary>
+    /// Create an uninitialized string of the given length, allocated in
+    /// the scratch arena if a ScratchScope is active. Meant for marshaling
+    /// code only: the string must not outlive the trampoline call
+    /// </summary>
+    inline cbstring CreateScratchStringFixed(size_t len)
+    {
+        auto newstr = (char*)ScratchArena::Alloc(len + 1);
+        if (newstr == nullptr)
+        {
+            auto ret = CBCreateStringFixed(len);
+            if (ret.data == nullptr)
+                throw std::bad_alloc();
+
+            return ret;
+        }
+
+        newstr[0] = '\0';
+        return cbstring{ newstr, len | CB_STRING_ARENA_FLAG };
+    }
+
+    /// <summary>
+    /// Transient string returned by a native method, eg. return cb::ScratchString(title).
+    /// The data is allocated in the scratch arena of the calling trampoline and is
+    /// valid until its ScratchScope exits, so returning it costs no malloc/free pair.
+    /// Without an active scope, eg. when called from .NET, it's heap allocated and
+    /// owned by the receiver as any other returned string
+    /// </summary>
+    class ScratchString final
+    {
+    public:
+        ScratchString(const char* str, size_t len)
+            : m_str(CreateScratchStringFixed(len))
+        {
+            auto data = (char*)m_str.data;
+            if (len != 0)
+                std::memcpy(data, str, len);
+
+            data[len] = '\0';
+        }
+
+        ScratchString(const std::string_view& str)
+            : ScratchString(str.data() == nullptr ? "" : str.data(), str.length()) { }
+
+        ScratchString(ScratchString&& str) noexcept
+            : m_str(str.m_str)
+        {
+            str.m_str = { };
+        }
+
+        ~ScratchString()
+        {
+            CBFreeString(&m_str);
+        }
+
+        ScratchString(const ScratchString&) = delete;
+        ScratchString& operator=(const ScratchString&) = delete;
+
+        cbstring release()
+        {
+            auto ret = m_str;
+            m_str = { };
+            return ret;
+        }
+
+    private:
+        cbstring m_str;
+    };
+
+    template <typename T>
+    struct ElementKind
+    {
+        static_assert(sizeof(T) == 0, "Unsupported buffer element type");
+    };
+
+    template <> struct ElementKind<uint8_t> { static constexpr int32_t Value = CB_ELEMENT_UINT8; };
+    template <> struct ElementKind<int8_t> { static constexpr int32_t Value = CB_ELEMENT_INT8; };
+    template <> struct ElementKind<uint16_t> { static constexpr int32_t Value = CB_ELEMENT_UINT16; };
+    template <> struct ElementKind<int16_t> { static constexpr int32_t Value = CB_ELEMENT_INT16; };
+    template <> struct ElementKind<uint32_t> { static constexpr int32_t Value = CB_ELEMENT_UINT32; };
+    template <> struct ElementKind<int32_t> { static constexpr int32_t Value = CB_ELEMENT_INT32; };
+    template <> struct ElementKind<uint64_t> { static constexpr int32_t Value = CB_ELEMENT_UINT64; };
+    template <> struct ElementKind<int64_t> { static constexpr int32_t Value = CB_ELEMENT_INT64; };
+    template <> struct ElementKind<float> { static constexpr int32_t Value = CB_ELEMENT_FLOAT; };
+    template <> struct ElementKind<double> { static constexpr int32_t Value = CB_ELEMENT_DOUBLE; };
+
+    /// <summary>
+    /// Create an uninitialized buffer owned by the receiver
+    /// </summary>
+    template <typename T>
+    cbbuffer CreateBuffer(size_t length)
+    {
+        auto ret = CBCreateBuffer(ElementKind<T>::Value, length);
+        if (ret.data == nullptr)
+            throw std::bad_alloc();
+
+        return ret;
+    }
+
+    template <typename T>
+    cbbuffer CreateBufferCopy(const T* data, size_t length)
+    {
+        auto ret = CBCreateBufferCopy(data, ElementKind<T>::Value, length);
+        if (ret.data == nullptr)
+            throw std::bad_alloc();
+
+        return ret;
+    }
+
+    /// <summary>
+    /// Pack a container of strings in a single allocation
+    /// </summary>
+    template <typename TContainer>
+    cbstringarray CreateStringArray(const TContainer& strings)
+    {
+        size_t count = 0;
+        size_t totalLength = 0;
+        for (auto& str : strings)
+        {
+            totalLength += std::string_view(str).length();
+            count++;
+        }
+
+        auto ret = CBCreateStringArrayFixed(count, totalLength);
+        if (ret.data == nullptr)
+            throw std::bad_alloc();
+
+        size_t i = 0;
+        for (auto& str : strings)
+        {
+            std::string_view view(str);
+            CBStringArraySet(&ret, i, view.data(), view.length());
+            i++;
+        }
+
+        return ret;
+    }
 }
 
 class cbstringbase
@@ -49,8 +334,7 @@ class cbstringbase
 public:
     ~cbstringbase()
     {
-        if ((m_str.opaque & CB_STRING_OWNSDATA_FLAG) != 0)
-            CBFreeMemory((char*)m_str.data);
+        CBFreeString(&m_str);
     }
 
 protected:
@@ -59,7 +343,7 @@ protected:
         cbstring ret{ };
         if (len != 0)
         {
-            auto newstr = (char*)CBAllocMemory(len + 1);
+            auto newstr = (char*)cb::AllocMemory(len + 1);
             std::memcpy(newstr, str, len);
             newstr[len] = '\0';
             ret.data = newstr;
@@ -261,6 +545,26 @@ public:
     cbstringr(const std::string& str)
         : cbstringbase(init(str.data(), str.length())) { }
 
+    // Return a string allocated in the scratch arena, see cb::ScratchString
+    cbstringr(cb::ScratchString&& str)
+        : cbstringbase(str.release()) { }
+
+    // Adopt an existing buffer without copying it. The release
+    // callback is invoked when the receiver frees the string
+    cbstringr(const char* str, size_t len, CBStringReleaseCallback release, void* context)
+        : cbstringbase(CBCreateStringExternal(str, len, release, context)) { }
+
+    /// <summary>
+    /// Adopt the buffer of the given string without copying it
+    /// </summary>
+    static cbstringr adopt(std::string&& str)
+    {
+        auto adopted = new std::string(std::move(str));
+        return cbstringr(adopted->data(), adopted->length(), [](void* context, const char*, size_t) {
+            delete (std::string*)context;
+        }, adopted);
+    }
+
     // Cast to cbstring with a move semantics
     operator cbstring() &&
     {
@@ -268,4 +572,101 @@ public:
     }
 };
 
+namespace cb
+{
+    /// <summary>
+    /// RAII wrapper over CBStringBuilder. Finish() hands the built
+    /// buffer over to a cbstringr without copying it
+    /// </summary>
+    class StringBuilder final
+    {
+    public:
+        StringBuilder()
+        {
+            CBStringBuilderInit(&m_builder);
+        }
+
+        explicit StringBuilder(size_t capacity)
+            : StringBuilder()
+        {
+            Reserve(capacity);
+        }
+
+        StringBuilder(StringBuilder&& builder) noexcept
+            : m_builder(builder.m_builder)
+        {
+            CBStringBuilderInit(&builder.m_builder);
+        }
+
+        ~StringBuilder()
+        {
+            CBStringBuilderFree(&m_builder);
+        }
+
+        StringBuilder(const StringBuilder&) = delete;
+        StringBuilder& operator=(const StringBuilder&) = delete;
+
+        void Reserve(size_t capacity)
+        {
+            if (!CBStringBuilderReserve(&m_builder, capacity))
+                throw std::bad_alloc();
+        }
+
+        StringBuilder& Append(const char* str, size_t len)
+        {
+            if (!CBStringBuilderAppendLen(&m_builder, str, len))
+                throw std::bad_alloc();
+
+            return *this;
+        }
+
+        StringBuilder& Append(const std::string_view& str)
+        {
+            return Append(str.data(), str.length());
+        }
+
+        StringBuilder& Append(char ch)
+        {
+            return Append(&ch, 1);
+        }
+
+        StringBuilder& operator+=(const std::string_view& str)
+        {
+            return Append(str);
+        }
+
+        StringBuilder& operator+=(char ch)
+        {
+            return Append(ch);
+        }
+
+        void Clear()
+        {
+            m_builder.length = 0;
+        }
+
+        size_t Length() const { return m_builder.length; }
+
+        std::string_view View() const
+        {
+            return std::string_view(m_builder.data == nullptr ? "" : m_builder.data, m_builder.length);
+        }
+
+        /// <summary>
+        /// Hand the buffer over and reset the builder
+        /// </summary>
+        cbstringr Finish()
+        {
+            auto ret = CBStringBuilderFinish(&m_builder);
+            if (ret.data == nullptr)
+                throw std::bad_alloc();
+
+            return cbstringr(std::move(ret));
+        }
+
+    private:
+        CBStringBuilder m_builder;
+    };
+}
+
 #endif // CODE_BINDER_INTEROP_CPP_HEADER
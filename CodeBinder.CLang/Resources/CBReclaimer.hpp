@@ -0,0 +1,291 @@
+﻿/**
+ * SPDX-FileCopyrightText: (C) 2023 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: MIT-0
+ */
+
+#ifndef CODE_BINDER_RECLAIMER_HEADER
+#define CODE_BINDER_RECLAIMER_HEADER
+#pragma once
+
+// Background reclamation of native handles, used by the trampolines of
+// [BackgroundRelease] methods. Handles are freed by a pool of threads
+// owned by the binding, through a bounded queue. When it's full, regular
+// callers release the handle synchronously. Finalizer threads, eg. the
+// GC finalizer thread or the JS event loop, must never stall, so they
+// can still enqueue in a bounded overflow region. Only if that's full
+// too they release synchronously. Both cases are counted in the stats
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef CB_RECLAIMER_THREADS
+#define CB_RECLAIMER_THREADS 2
+#endif // CB_RECLAIMER_THREADS
+
+// Capacity of the queue for regular callers
+#ifndef CB_RECLAIMER_CAPACITY
+#define CB_RECLAIMER_CAPACITY 4096
+#endif // CB_RECLAIMER_CAPACITY
+
+// Further capacity available only to finalizer threads
+#ifndef CB_RECLAIMER_OVERFLOW_CAPACITY
+#define CB_RECLAIMER_OVERFLOW_CAPACITY 4096
+#endif // CB_RECLAIMER_OVERFLOW_CAPACITY
+
+typedef struct
+{
+    uint64_t enqueued;
+    uint64_t released;
+    uint64_t depth;
+    uint64_t max_depth;
+    uint64_t capacity;
+    uint64_t overflow_capacity;
+    uint64_t overflowed;
+    uint64_t released_synchronously;
+} CBReclaimerStats;
+
+namespace cb
+{
+    /// <summary>
+    /// Bounded queue of handles, consumed by CB_RECLAIMER_THREADS
+    /// threads that are started with the first enqueued handle.
+    /// Shutdown() drains the queue and joins the threads, which are
+    /// started again by the next enqueued handle
+    /// </summary>
+    class Reclaimer final
+    {
+    public:
+        typedef void(*ReleaseFunc)(void*);
+
+    private:
+        struct Item
+        {
+            ReleaseFunc release;
+            void* handle;
+        };
+
+    public:
+        static Reclaimer& Instance()
+        {
+            // Intentionally leaked, as finalizer threads may still
+            // enqueue handles while static objects are destroyed at
+            // process exit. The workers are joined by s_guard instead
+            static Reclaimer* s_instance = new Reclaimer();
+            static Guard s_guard(*s_instance);
+            return *s_instance;
+        }
+
+        /// <summary>
+        /// Mark the current thread as a finalizer thread, which must never
+        /// stall releasing handles, see CB_RECLAIMER_OVERFLOW_CAPACITY
+        /// </summary>
+        static void SetFinalizerThread()
+        {
+            finalizerThread() = true;
+        }
+
+        Reclaimer(const Reclaimer&) = delete;
+        Reclaimer& operator=(const Reclaimer&) = delete;
+
+    public:
+        void Enqueue(ReleaseFunc release, void* handle)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            size_t capacity = finalizerThread()
+                ? CB_RECLAIMER_CAPACITY + CB_RECLAIMER_OVERFLOW_CAPACITY
+                : CB_RECLAIMER_CAPACITY;
+            if (m_stopping || m_closed || m_count >= capacity)
+            {
+                m_releasedSynchronously++;
+                lock.unlock();
+                release(handle);
+                return;
+            }
+
+            if (m_threads.empty())
+            {
+                for (unsigned i = 0; i < CB_RECLAIMER_THREADS; i++)
+                    m_threads.emplace_back(&Reclaimer::run, this);
+            }
+
+            if (m_count >= CB_RECLAIMER_CAPACITY)
+                m_overflowed++;
+
+            m_items[(m_head + m_count) % m_items.size()] = { release, handle };
+            m_count++;
+            m_enqueued++;
+            if (m_count > m_maxDepth)
+                m_maxDepth = m_count;
+
+            lock.unlock();
+            m_notEmpty.notify_one();
+        }
+
+        /// <summary>
+        /// Release the queued handles and join the threads. It must be
+        /// called before the library is unloaded where the static
+        /// destructors can't join them, see Guard
+        /// </summary>
+        void Shutdown()
+        {
+            std::vector<std::thread> threads;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_stopping || m_threads.empty())
+                    return;
+
+                // Handles enqueued while stopping are released synchronously
+                m_stopping = true;
+                threads.swap(m_threads);
+            }
+
+            m_notEmpty.notify_all();
+            for (auto& thread : threads)
+            {
+                if (thread.get_id() == std::this_thread::get_id())
+                    thread.detach();
+                else
+                    thread.join();
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = false;
+        }
+
+        void GetStats(CBReclaimerStats& stats)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            stats.enqueued = m_enqueued;
+            stats.released = m_released.load(std::memory_order_relaxed);
+            stats.depth = m_count;
+            stats.max_depth = m_maxDepth;
+            stats.capacity = CB_RECLAIMER_CAPACITY;
+            stats.overflow_capacity = CB_RECLAIMER_OVERFLOW_CAPACITY;
+            stats.overflowed = m_overflowed;
+            stats.released_synchronously = m_releasedSynchronously;
+        }
+
+    private:
+        // Joins the workers when the library is unloaded or the process
+        // exits, so they never run code of an unloaded library. On Windows
+        // static destructors run under the loader lock, where joining would
+        // deadlock on FreeLibrary, and the workers are already terminated
+        // at process exit: hosts unloading the library must call
+        // CB_ShutdownReclaimer() before, as done by JNI_OnUnload and by
+        // the NAPI env teardown
+        class Guard final
+        {
+        public:
+            Guard(Reclaimer& reclaimer)
+                : m_reclaimer(reclaimer) { }
+
+            ~Guard()
+            {
+#ifndef _WIN32
+                m_reclaimer.Shutdown();
+#endif
+                // Late handles, eg. from finalizers running at
+                // process exit, are released synchronously
+                std::lock_guard<std::mutex> lock(m_reclaimer.m_mutex);
+                m_reclaimer.m_closed = true;
+                for (auto& thread : m_reclaimer.m_threads)
+                    thread.detach();
+
+                m_reclaimer.m_threads.clear();
+            }
+
+        private:
+            Reclaimer& m_reclaimer;
+        };
+
+        Reclaimer()
+            : m_items(CB_RECLAIMER_CAPACITY + CB_RECLAIMER_OVERFLOW_CAPACITY), m_stopping(false), m_closed(false),
+            m_head(0), m_count(0), m_enqueued(0), m_maxDepth(0), m_overflowed(0),
+            m_releasedSynchronously(0), m_released(0) { }
+
+        static bool& finalizerThread()
+        {
+            thread_local bool s_finalizerThread = false;
+            return s_finalizerThread;
+        }
+
+        void run()
+        {
+            while (true)
+            {
+                Item item;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_notEmpty.wait(lock, [this] { return m_count != 0 || m_stopping; });
+                    if (m_count == 0)
+                        return;
+
+                    item = m_items[m_head];
+                    m_head = (m_head + 1) % m_items.size();
+                    m_count--;
+                }
+
+                item.release(item.handle);
+                m_released.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_notEmpty;
+        std::vector<Item> m_items;
+        std::vector<std::thread> m_threads;
+        bool m_stopping;
+        bool m_closed;
+        size_t m_head;
+        size_t m_count;
+        uint64_t m_enqueued;
+        uint64_t m_maxDepth;
+        uint64_t m_overflowed;
+        uint64_t m_releasedSynchronously;
+        std::atomic<uint64_t> m_released;
+    };
+
+    template <typename TRelease>
+    struct ReleaseTraits;
+
+    template <typename THandle>
+    struct ReleaseTraits<void(*)(THandle)>
+    {
+        typedef THandle Handle;
+    };
+
+    /// <summary>
+    /// Hand over the handle to the reclamation threads, which will
+    /// call the release function, eg. Reclaim<SLFreeDocument>(doc)
+    /// </summary>
+    template <auto Release>
+    void Reclaim(typename ReleaseTraits<decltype(Release)>::Handle handle)
+    {
+        Reclaimer::Instance().Enqueue([](void* handle) {
+            Release((typename ReleaseTraits<decltype(Release)>::Handle)handle);
+        }, (void*)handle);
+    }
+
+    inline void SetReclaimerFinalizerThread()
+    {
+        Reclaimer::SetFinalizerThread();
+    }
+
+    inline void ShutdownReclaimer()
+    {
+        Reclaimer::Instance().Shutdown();
+    }
+
+    inline void GetReclaimerStats(CBReclaimerStats& stats)
+    {
+        Reclaimer::Instance().GetStats(stats);
+    }
+}
+
+#endif // CODE_BINDER_RECLAIMER_HEADER
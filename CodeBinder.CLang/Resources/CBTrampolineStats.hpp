@@ -0,0 +1,264 @@
+﻿/**
+ * SPDX-FileCopyrightText: (C) 2023 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: MIT-0
+ */
+
+#ifndef CODE_BINDER_TRAMPOLINE_STATS_HEADER
+#define CODE_BINDER_TRAMPOLINE_STATS_HEADER
+#pragma once
+
+// Opt-in per trampoline call instrumentation. Define CB_TRAMPOLINE_STATS
+// when compiling the generated bindings to record call counts, latency
+// histograms and marshaled bytes. When it's not defined the probes
+// expand to nothing and no trampoline is listed
+
+#include <cstddef>
+#include <cstdint>
+
+// Latency buckets are powers of two: bucket 0 counts calls faster than
+// 64ns, bucket i calls in [2^(i+5), 2^(i+6)) ns, the last one the rest
+#define CB_TRAMPOLINE_HISTOGRAM_BUCKETS 16
+
+typedef struct
+{
+    const char* name;
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t bytes;
+    uint64_t histogram[CB_TRAMPOLINE_HISTOGRAM_BUCKETS];
+} CBTrampolineStats;
+
+#ifdef CB_TRAMPOLINE_STATS
+
+#include <atomic>
+#include <chrono>
+
+namespace cb
+{
+    /// <summary>
+    /// Counters of a single trampoline, owned by a single thread at a time.
+    /// Only the owner thread writes them, so updates don't need atomic
+    /// read-modify-write operations, while snapshots can be taken at any
+    /// time from other threads. When the owner exits the counters are
+    /// handed over to the next thread calling the trampoline
+    /// </summary>
+    struct TrampolineCounters final
+    {
+        TrampolineCounters* next;
+        std::atomic<bool> owned;
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> totalNs;
+        std::atomic<uint64_t> bytes;
+        std::atomic<uint64_t> histogram[CB_TRAMPOLINE_HISTOGRAM_BUCKETS];
+
+        void record(uint64_t elapsedNs, uint64_t marshaledBytes)
+        {
+            add(calls, 1);
+            add(totalNs, elapsedNs);
+            add(bytes, marshaledBytes);
+
+            unsigned bucket = 0;
+            for (uint64_t value = elapsedNs >> 6; value != 0 && bucket < CB_TRAMPOLINE_HISTOGRAM_BUCKETS - 1; value >>= 1)
+                bucket++;
+
+            add(histogram[bucket], 1);
+        }
+
+    private:
+        static void add(std::atomic<uint64_t>& counter, uint64_t value)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+    };
+
+    /// <summary>
+    /// A single instrumented trampoline. Sites register themselves in a
+    /// lock-free list on the first call, and each calling thread acquires
+    /// its own counters from the site. Counters of exited threads are
+    /// recycled with their values, so totals never go backwards and the
+    /// list is bounded by the peak number of concurrent threads
+    /// </summary>
+    class TrampolineSite final
+    {
+    public:
+        TrampolineSite(const char* name)
+            : m_name(name), m_counters(nullptr)
+        {
+            auto& head = sites();
+            m_next = head.load(std::memory_order_relaxed);
+            while (!head.compare_exchange_weak(m_next, this, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        TrampolineSite(const TrampolineSite&) = delete;
+        TrampolineSite& operator=(const TrampolineSite&) = delete;
+
+    public:
+        TrampolineCounters& AcquireCounters()
+        {
+            for (auto counters = m_counters.load(std::memory_order_acquire); counters != nullptr; counters = counters->next)
+            {
+                // Acquire pairs with the release in ReleaseCounters(), so the
+                // values written by the previous owner are visible
+                bool owned = false;
+                if (!counters->owned.load(std::memory_order_relaxed)
+                    && counters->owned.compare_exchange_strong(owned, true, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    return *counters;
+                }
+            }
+
+            auto counters = new TrampolineCounters();
+            counters->owned.store(true, std::memory_order_relaxed);
+            counters->next = m_counters.load(std::memory_order_relaxed);
+            while (!m_counters.compare_exchange_weak(counters->next, counters, std::memory_order_release, std::memory_order_relaxed));
+            return *counters;
+        }
+
+        static void ReleaseCounters(TrampolineCounters& counters)
+        {
+            counters.owned.store(false, std::memory_order_release);
+        }
+
+        void Snapshot(CBTrampolineStats& stats) const
+        {
+            stats = { };
+            stats.name = m_name;
+            for (auto counters = m_counters.load(std::memory_order_acquire); counters != nullptr; counters = counters->next)
+            {
+                stats.calls += counters->calls.load(std::memory_order_relaxed);
+                stats.total_ns += counters->totalNs.load(std::memory_order_relaxed);
+                stats.bytes += counters->bytes.load(std::memory_order_relaxed);
+                for (unsigned i = 0; i < CB_TRAMPOLINE_HISTOGRAM_BUCKETS; i++)
+                    stats.histogram[i] += counters->histogram[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        const TrampolineSite* Next() const { return m_next; }
+
+        static std::atomic<TrampolineSite*>& sites()
+        {
+            static std::atomic<TrampolineSite*> s_head;
+            return s_head;
+        }
+
+    private:
+        const char* m_name;
+        TrampolineSite* m_next;
+        std::atomic<TrampolineCounters*> m_counters;
+    };
+
+    /// <summary>
+    /// Counters of a site owned by the current thread until it exits
+    /// </summary>
+    class TrampolineCountersLease final
+    {
+    public:
+        TrampolineCountersLease(TrampolineSite& site)
+            : m_counters(site.AcquireCounters()) { }
+
+        ~TrampolineCountersLease()
+        {
+            TrampolineSite::ReleaseCounters(m_counters);
+        }
+
+        TrampolineCountersLease(const TrampolineCountersLease&) = delete;
+        TrampolineCountersLease& operator=(const TrampolineCountersLease&) = delete;
+
+        TrampolineCounters& Counters() { return m_counters; }
+
+    private:
+        TrampolineCounters& m_counters;
+    };
+
+    /// <summary>
+    /// Time the enclosing trampoline and collect the bytes reported by
+    /// the marshaling helpers while it's active
+    /// </summary>
+    class TrampolineProbe final
+    {
+    public:
+        TrampolineProbe(TrampolineCounters& counters)
+            : m_counters(counters), m_previous(current()), m_bytes(0),
+            m_start(std::chrono::steady_clock::now())
+        {
+            current() = this;
+        }
+
+        ~TrampolineProbe()
+        {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - m_start).count();
+            m_counters.record((uint64_t)elapsed, m_bytes);
+            current() = m_previous;
+        }
+
+        TrampolineProbe(const TrampolineProbe&) = delete;
+        TrampolineProbe& operator=(const TrampolineProbe&) = delete;
+
+    public:
+        static void AddBytes(size_t bytes)
+        {
+            auto probe = current();
+            if (probe != nullptr)
+                probe->m_bytes += bytes;
+        }
+
+    private:
+        static TrampolineProbe*& current()
+        {
+            static thread_local TrampolineProbe* s_current;
+            return s_current;
+        }
+
+    private:
+        TrampolineCounters& m_counters;
+        TrampolineProbe* m_previous;
+        uint64_t m_bytes;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    /// <summary>
+    /// Copy the statistics of up to count trampolines and return the
+    /// number of instrumented trampolines. Only trampolines called at
+    /// least once are listed
+    /// </summary>
+    inline size_t GetTrampolineStats(CBTrampolineStats* stats, size_t count)
+    {
+        size_t ret = 0;
+        for (const TrampolineSite* site = TrampolineSite::sites().load(std::memory_order_acquire); site != nullptr; site = site->Next())
+        {
+            if (ret < count)
+                site->Snapshot(stats[ret]);
+
+            ret++;
+        }
+
+        return ret;
+    }
+}
+
+#define CB_TRAMPOLINE_PROBE(name) \
+    static cb::TrampolineSite cbsite_(name); \
+    static thread_local cb::TrampolineCountersLease cblease_(cbsite_); \
+    cb::TrampolineProbe cbprobe_(cblease_.Counters())
+
+#define CB_TRAMPOLINE_BYTES(bytes) cb::TrampolineProbe::AddBytes(bytes)
+
+#else // CB_TRAMPOLINE_STATS
+
+namespace cb
+{
+    inline size_t GetTrampolineStats(CBTrampolineStats* stats, size_t count)
+    {
+        (void)stats;
+        (void)count;
+        return 0;
+    }
+}
+
+#define CB_TRAMPOLINE_PROBE(name) (void)0
+#define CB_TRAMPOLINE_BYTES(bytes) (void)0
+
+#endif // CB_TRAMPOLINE_STATS
+
+#endif // CODE_BINDER_TRAMPOLINE_STATS_HEADER
@@ -0,0 +1,533 @@
+﻿/**
+ * SPDX-FileCopyrightText: (C) 2023 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: MIT-0
+ */
+
+#ifndef CODE_BINDER_UNICODE_HEADER
+#define CODE_BINDER_UNICODE_HEADER
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CB_UNICODE_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#define CB_UNICODE_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CB_UNICODE_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(CB_UNICODE_AVX2) && !defined(__AVX2__) && (defined(__GNUC__) || defined(__clang__))
+#define CB_UNICODE_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define CB_UNICODE_AVX2_TARGET
+#endif
+
+/// <summary>
+/// UTF-8 <-> UTF-16 transcoding. ASCII runs are processed in SIMD blocks
+/// (SSE2/AVX2 on x86, NEON on AArch64), the rest is decoded one code
+/// point at a time. Ill-formed input, including unpaired surrogates,
+/// is replaced with U+FFFD, so conversions never fail
+/// </summary>
+namespace cb
+{
+    namespace unicode
+    {
+        constexpr uint32_t ReplacementChar = 0xFFFD;
+
+#ifdef CB_UNICODE_AVX2
+        inline bool HasAVX2()
+        {
+#if defined(__AVX2__)
+            return true;
+#elif defined(_MSC_VER)
+            static const bool s_hasAVX2 = []() {
+                int info[4];
+                __cpuid(info, 1);
+                // Check OSXSAVE and AVX, then the OS saves the YMM state
+                if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+                    return false;
+
+                if ((_xgetbv(0) & 6) != 6)
+                    return false;
+
+                __cpuidex(info, 7, 0);
+                return (info[1] & (1 << 5)) != 0;
+            }();
+            return s_hasAVX2;
+#else
+            static const bool s_hasAVX2 = __builtin_cpu_supports("avx2") != 0;
+            return s_hasAVX2;
+#endif
+        }
+
+        CB_UNICODE_AVX2_TARGET inline size_t WidenAsciiAVX2(const uint8_t* src, size_t len, uint16_t* dst)
+        {
+            size_t i = 0;
+            for (; i + 32 <= len; i += 32)
+            {
+                __m256i v = _mm256_loadu_si256((const __m256i*)(src + i));
+                if (_mm256_movemask_epi8(v) != 0)
+                    break;
+
+                _mm256_storeu_si256((__m256i*)(dst + i), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+                _mm256_storeu_si256((__m256i*)(dst + i + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+            }
+
+            return i;
+        }
+
+        CB_UNICODE_AVX2_TARGET inline size_t NarrowAsciiAVX2(const uint16_t* src, size_t len, uint8_t* dst)
+        {
+            const __m256i mask = _mm256_set1_epi16((short)0xFF80);
+            size_t i = 0;
+            for (; i + 32 <= len; i += 32)
+            {
+                __m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+                __m256i b = _mm256_loadu_si256((const __m256i*)(src + i + 16));
+                if (!_mm256_testz_si256(_mm256_or_si256(a, b), mask))
+                    break;
+
+                // packus works on 128 bit lanes, so restore the order
+                __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+                _mm256_storeu_si256((__m256i*)(dst + i), packed);
+            }
+
+            return i;
+        }
+
+        CB_UNICODE_AVX2_TARGET inline size_t SkipAscii8AVX2(const uint8_t* src, size_t len)
+        {
+            size_t i = 0;
+            for (; i + 32 <= len; i += 32)
+            {
+                if (_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)(src + i))) != 0)
+                    break;
+            }
+
+            return i;
+        }
+
+        CB_UNICODE_AVX2_TARGET inline size_t SkipAscii16AVX2(const uint16_t* src, size_t len)
+        {
+            const __m256i mask = _mm256_set1_epi16((short)0xFF80);
+            size_t i = 0;
+            for (; i + 16 <= len; i += 16)
+            {
+                if (!_mm256_testz_si256(_mm256_loadu_si256((const __m256i*)(src + i)), mask))
+                    break;
+            }
+
+            return i;
+        }
+#endif // CB_UNICODE_AVX2
+
+        /// <summary>
+        /// Widen the leading ASCII blocks, returning the number of
+        /// processed code units. The remainder is left to the caller
+        /// </summary>
+        inline size_t WidenAscii(const uint8_t* src, size_t len, uint16_t* dst)
+        {
+            size_t i = 0;
+#ifdef CB_UNICODE_AVX2
+            if (HasAVX2())
+                i = WidenAsciiAVX2(src, len, dst);
+#endif
+#if defined(CB_UNICODE_SSE2)
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= len; i += 16)
+            {
+                __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+                if (_mm_movemask_epi8(v) != 0)
+                    break;
+
+                _mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi8(v, zero));
+                _mm_storeu_si128((__m128i*)(dst + i + 8), _mm_unpackhi_epi8(v, zero));
+            }
+#elif defined(CB_UNICODE_NEON)
+            for (; i + 16 <= len; i += 16)
+            {
+                uint8x16_t v = vld1q_u8(src + i);
+                if (vmaxvq_u8(v) >= 0x80)
+                    break;
+
+                vst1q_u16(dst + i, vmovl_u8(vget_low_u8(v)));
+                vst1q_u16(dst + i + 8, vmovl_high_u8(v));
+            }
+#endif
+            return i;
+        }
+
+        /// <summary>
+        /// Narrow the leading ASCII blocks, returning the number of
+        /// processed code units. The remainder is left to the caller
+        /// </summary>
+        inline size_t NarrowAscii(const uint16_t* src, size_t len, uint8_t* dst)
+        {
+            size_t i = 0;
+#ifdef CB_UNICODE_AVX2
+            if (HasAVX2())
+                i = NarrowAsciiAVX2(src, len, dst);
+#endif
+#if defined(CB_UNICODE_SSE2)
+            const __m128i mask = _mm_set1_epi16((short)0xFF80);
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= len; i += 16)
+            {
+                __m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+                __m128i b = _mm_loadu_si128((const __m128i*)(src + i + 8));
+                __m128i high = _mm_and_si128(_mm_or_si128(a, b), mask);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xFFFF)
+                    break;
+
+                _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(a, b));
+            }
+#elif defined(CB_UNICODE_NEON)
+            for (; i + 16 <= len; i += 16)
+            {
+                uint16x8_t a = vld1q_u16(src + i);
+                uint16x8_t b = vld1q_u16(src + i + 8);
+                if (vmaxvq_u16(vorrq_u16(a, b)) >= 0x80)
+                    break;
+
+                vst1q_u8(dst + i, vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+            }
+#endif
+            return i;
+        }
+
+        // Return the length of the leading ASCII blocks
+        inline size_t SkipAscii8(const uint8_t* src, size_t len)
+        {
+            size_t i = 0;
+#ifdef CB_UNICODE_AVX2
+            if (HasAVX2())
+                i = SkipAscii8AVX2(src, len);
+#endif
+#if defined(CB_UNICODE_SSE2)
+            for (; i + 16 <= len; i += 16)
+            {
+                if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(src + i))) != 0)
+                    break;
+            }
+#elif defined(CB_UNICODE_NEON)
+            for (; i + 16 <= len; i += 16)
+            {
+                if (vmaxvq_u8(vld1q_u8(src + i)) >= 0x80)
+                    break;
+            }
+#endif
+            return i;
+        }
+
+        // Return the length of the leading ASCII blocks
+        inline size_t SkipAscii16(const uint16_t* src, size_t len)
+        {
+            size_t i = 0;
+#ifdef CB_UNICODE_AVX2
+            if (HasAVX2())
+                i = SkipAscii16AVX2(src, len);
+#endif
+#if defined(CB_UNICODE_SSE2)
+            const __m128i mask = _mm_set1_epi16((short)0xFF80);
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 8 <= len; i += 8)
+            {
+                __m128i high = _mm_and_si128(_mm_loadu_si128((const __m128i*)(src + i)), mask);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xFFFF)
+                    break;
+            }
+#elif defined(CB_UNICODE_NEON)
+            for (; i + 8 <= len; i += 8)
+            {
+                if (vmaxvq_u16(vld1q_u16(src + i)) >= 0x80)
+                    break;
+            }
+#endif
+            return i;
+        }
+
+        /// <summary>
+        /// Decode the non ASCII sequence at the given position, returning
+        /// the number of consumed bytes. Ill-formed sequences decode
+        /// to U+FFFD and consume a single byte
+        /// </summary>
+        inline size_t DecodeUtf8(const uint8_t* src, size_t len, uint32_t& codepoint)
+        {
+            uint8_t lead = src[0];
+            size_t count;
+            uint8_t lower = 0x80;
+            uint8_t upper = 0xBF;
+            if (lead >= 0xC2 && lead <= 0xDF)
+            {
+                count = 2;
+                codepoint = lead & 0x1F;
+            }
+            else if (lead >= 0xE0 && lead <= 0xEF)
+            {
+                count = 3;
+                codepoint = lead & 0x0F;
+                if (lead == 0xE0)
+                    lower = 0xA0; // Overlong
+                else if (lead == 0xED)
+                    upper = 0x9F; // Surrogates
+            }
+            else if (lead >= 0xF0 && lead <= 0xF4)
+            {
+                count = 4;
+                codepoint = lead & 0x07;
+                if (lead == 0xF0)
+                    lower = 0x90; // Overlong
+                else if (lead == 0xF4)
+                    upper = 0x8F; // Above U+10FFFF
+            }
+            else
+            {
+                codepoint = ReplacementChar;
+                return 1;
+            }
+
+            if (len < count || src[1] < lower || src[1] > upper)
+            {
+                codepoint = ReplacementChar;
+                return 1;
+            }
+
+            codepoint = (codepoint << 6) | (src[1] & 0x3F);
+            for (size_t i = 2; i < count; i++)
+            {
+                if ((src[i] & 0xC0) != 0x80)
+                {
+                    codepoint = ReplacementChar;
+                    return 1;
+                }
+
+                codepoint = (codepoint << 6) | (src[i] & 0x3F);
+            }
+
+            return count;
+        }
+
+        /// <summary>
+        /// Decode the non ASCII code point at the given position, returning
+        /// the number of consumed units. Unpaired surrogates decode to U+FFFD
+        /// </summary>
+        inline size_t DecodeUtf16(const uint16_t* src, size_t len, uint32_t& codepoint)
+        {
+            uint16_t unit = src[0];
+            if (unit < 0xD800 || unit > 0xDFFF)
+            {
+                codepoint = unit;
+                return 1;
+            }
+
+            if (unit <= 0xDBFF && len >= 2 && src[1] >= 0xDC00 && src[1] <= 0xDFFF)
+            {
+                codepoint = 0x10000 + (((uint32_t)unit - 0xD800) << 10) + ((uint32_t)src[1] - 0xDC00);
+                return 2;
+            }
+
+            codepoint = ReplacementChar;
+            return 1;
+        }
+    }
+
+    /// <summary>
+    /// Return the number of UTF-16 units needed to convert the UTF-8 string,
+    /// which is never larger than the number of input bytes
+    /// </summary>
+    inline size_t Utf8ToUtf16Length(const char* str, size_t len)
+    {
+        auto src = (const uint8_t*)str;
+        size_t i = 0;
+        size_t ret = 0;
+        while (i < len)
+        {
+            if (src[i] < 0x80)
+            {
+                size_t ascii = unicode::SkipAscii8(src + i, len - i);
+                i += ascii;
+                ret += ascii;
+                while (i < len && src[i] < 0x80)
+                {
+                    i++;
+                    ret++;
+                }
+
+                continue;
+            }
+
+            uint32_t codepoint;
+            i += unicode::DecodeUtf8(src + i, len - i, codepoint);
+            ret += codepoint >= 0x10000 ? 2 : 1;
+        }
+
+        return ret;
+    }
+
+    /// <summary>
+    /// Convert the UTF-8 string to UTF-16, returning the number of written
+    /// units. The destination must hold at least Utf8ToUtf16Length() units,
+    /// or simply len units
+    /// </summary>
+    inline size_t Utf8ToUtf16(const char* str, size_t len, uint16_t* dst)
+    {
+        auto src = (const uint8_t*)str;
+        size_t i = 0;
+        size_t o = 0;
+        while (i < len)
+        {
+            if (src[i] < 0x80)
+            {
+                size_t ascii = unicode::WidenAscii(src + i, len - i, dst + o);
+                i += ascii;
+                o += ascii;
+                while (i < len && src[i] < 0x80)
+                    dst[o++] = src[i++];
+
+                continue;
+            }
+
+            uint32_t codepoint;
+            i += unicode::DecodeUtf8(src + i, len - i, codepoint);
+            if (codepoint >= 0x10000)
+            {
+                codepoint -= 0x10000;
+                dst[o++] = (uint16_t)(0xD800 + (codepoint >> 10));
+                dst[o++] = (uint16_t)(0xDC00 + (codepoint & 0x3FF));
+            }
+            else
+            {
+                dst[o++] = (uint16_t)codepoint;
+            }
+        }
+
+        return o;
+    }
+
+    /// <summary>
+    /// Return the number of UTF-8 bytes needed to convert the UTF-16 string,
+    /// which is never larger than three times the number of input units
+    /// </summary>
+    inline size_t Utf16ToUtf8Length(const uint16_t* str, size_t len)
+    {
+        size_t i = 0;
+        size_t ret = 0;
+        while (i < len)
+        {
+            if (str[i] < 0x80)
+            {
+                size_t ascii = unicode::SkipAscii16(str + i, len - i);
+                i += ascii;
+                ret += ascii;
+                while (i < len && str[i] < 0x80)
+                {
+                    i++;
+                    ret++;
+                }
+
+                continue;
+            }
+
+            uint32_t codepoint;
+            i += unicode::DecodeUtf16(str + i, len - i, codepoint);
+            if (codepoint < 0x800)
+                ret += 2;
+            else if (codepoint < 0x10000)
+                ret += 3;
+            else
+                ret += 4;
+        }
+
+        return ret;
+    }
+
+    /// <summary>
+    /// Convert the UTF-16 string to UTF-8, returning the number of written
+    /// bytes. The destination must hold at least Utf16ToUtf8Length() bytes,
+    /// or simply 3 * len bytes. No terminator is written
+    /// </summary>
+    inline size_t Utf16ToUtf8(const uint16_t* str, size_t len, char* dst)
+    {
+        auto out = (uint8_t*)dst;
+        size_t i = 0;
+        size_t o = 0;
+        while (i < len)
+        {
+            if (str[i] < 0x80)
+            {
+                size_t ascii = unicode::NarrowAscii(str + i, len - i, out + o);
+                i += ascii;
+                o += ascii;
+                while (i < len && str[i] < 0x80)
+                    out[o++] = (uint8_t)str[i++];
+
+                continue;
+            }
+
+            uint32_t codepoint;
+            i += unicode::DecodeUtf16(str + i, len - i, codepoint);
+            if (codepoint < 0x800)
+            {
+                out[o++] = (uint8_t)(0xC0 | (codepoint >> 6));
+                out[o++] = (uint8_t)(0x80 | (codepoint & 0x3F));
+            }
+            else if (codepoint < 0x10000)
+            {
+                out[o++] = (uint8_t)(0xE0 | (codepoint >> 12));
+                out[o++] = (uint8_t)(0x80 | ((codepoint >> 6) & 0x3F));
+                out[o++] = (uint8_t)(0x80 | (codepoint & 0x3F));
+            }
+            else
+            {
+                out[o++] = (uint8_t)(0xF0 | (codepoint >> 18));
+                out[o++] = (uint8_t)(0x80 | ((codepoint >> 12) & 0x3F));
+                out[o++] = (uint8_t)(0x80 | ((codepoint >> 6) & 0x3F));
+                out[o++] = (uint8_t)(0x80 | (codepoint & 0x3F));
+            }
+        }
+
+        return o;
+    }
+
+    /// <summary>
+    /// Check the string is well-formed UTF-8
+    /// </summary>
+    inline bool ValidateUtf8(const char* str, size_t len)
+    {
+        auto src = (const uint8_t*)str;
+        size_t i = 0;
+        while (i < len)
+        {
+            if (src[i] < 0x80)
+            {
+                i += unicode::SkipAscii8(src + i, len - i);
+                while (i < len && src[i] < 0x80)
+                    i++;
+
+                continue;
+            }
+
+            uint32_t codepoint;
+            size_t consumed = unicode::DecodeUtf8(src + i, len - i, codepoint);
+            if (consumed == 1)
+                return false;
+
+            i += consumed;
+        }
+
+        return true;
+    }
+}
+
+#endif // CODE_BINDER_UNICODE_HEADER
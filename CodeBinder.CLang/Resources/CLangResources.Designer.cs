@@ -149,5 +149,82 @@ namespace CodeBinder.CLang {
                 return ResourceManager.GetString("CBInterop_hpp", resourceCulture);
             }
         }
+        
+        /// <summary>
+        ///   Looks up a localized string similar to #ifndef CODE_BINDER_RECLAIMER_HEADER
+        ///#define CODE_BINDER_RECLAIMER_HEADER
+        ///#pragma once
+        ///
+        ///// Background reclamation of native handles, used by the trampolines of
+        ///// [BackgroundRelease] methods. Handles are freed by a pool of threads
+        ///// owned by the binding. The queue is bounded: when it&apos;s full the thread
+        ///// handing over the handle waits for a free slot, so that producers slow
+        ///// down instead of accumulating unreleased memory
+        ///
+        ///#include &lt;cstddef&gt;
+        ///#include &lt;cstdint&gt;
+        ///#include &lt;atomic&gt;
+        ///#include &lt;chrono&gt;
+        ///#inc [rest of string was truncated]&quot;;.
+        /// </summary>
+        internal static string CBReclaimer_hpp {
+            get {
+                return ResourceManager.GetString("CBReclaimer_hpp", resourceCulture);
+            }
+        }
+        
+        /// <summary>
+        ///   Looks up a localized string similar to #ifndef CODE_BINDER_TRAMPOLINE_STATS_HEADER
+        ///#define CODE_BINDER_TRAMPOLINE_STATS_HEADER
+        ///#pragma once
+        ///
+        ///// Opt-in per trampoline call instrumentation. Define CB_TRAMPOLINE_STATS
+        ///// when compiling the generated bindings to record call counts, latency
+        ///// histograms and marshaled bytes. When it&apos;s not defined the probes
+        ///// expand to nothing
+        ///
+        ///#ifdef CB_TRAMPOLINE_STATS
+        ///
+        ///#include &lt;cstddef&gt;
+        ///#include &lt;cstdint&gt;
+        ///#include &lt;atomic&gt;
+        ///#include &lt;chrono&gt;
+        ///
+        ///// Latency buckets are powers of two: bucket 0 counts calls faster than
+        ///// 64ns, bucket i [rest of string was truncated]&quot;;.
+        /// </summary>
+        internal static string CBTrampolineStats_hpp {
+            get {
+                return ResourceManager.GetString("CBTrampolineStats_hpp", resourceCulture);
+            }
+        }
+        
+        /// <summary>
+        ///   Looks up a localized string similar to #ifndef CODE_BINDER_UNICODE_HEADER
+        ///#define CODE_BINDER_UNICODE_HEADER
+        ///#pragma once
+        ///
+        ///#include &lt;cstddef&gt;
+        ///#include &lt;cstdint&gt;
+        ///
+        ///#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+        ///#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) &amp;&amp; _M_IX86_FP &gt;= 2)
+        ///#define CB_UNICODE_SSE2
+        ///#include &lt;emmintrin.h&gt;
+        ///#endif
+        ///#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+        ///#define CB_UNICODE_AVX2
+        ///#include &lt;immintrin.h&gt;
+        ///#ifdef _MSC_VER
+        ///#include &lt;intrin.h&gt;
+        ///#endif
+        ///#endif
+        ///#elif defined(__aarch64__) || d [rest of string was truncated]&quot;;.
+        /// </summary>
+        internal static string CBUnicode_hpp {
+            get {
+                return ResourceManager.GetString("CBUnicode_hpp", resourceCulture);
+            }
+        }
     }
 }
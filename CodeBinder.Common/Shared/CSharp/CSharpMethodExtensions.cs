@@ -798,6 +798,30 @@ public static class CSharpMethodExtensions
         return method.Modifiers.Any(SyntaxKind.ExternKeyword);
     }
 
+    /// <summary>
+    /// Get the [BatchedRelease] native method invoked by a FreeHandle body,
+    /// which must consist of the single call, eg. { SLFreeDocument(handle); }
+    /// </summary>
+    public static bool TryGetBatchedReleaseMethod(this BlockSyntax body, ICompilationProvider provider,
+        [NotNullWhen(true)]out IMethodSymbol? method)
+    {
+        method = null;
+        if (body.Statements.Count != 1
+            || body.Statements[0] is not ExpressionStatementSyntax statement
+            || statement.Expression is not InvocationExpressionSyntax invocation
+            || invocation.ArgumentList.Arguments.Count != 1
+            || !invocation.TryGetSymbol(provider, out IMethodSymbol? symbol))
+        {
+            return false;
+        }
+
+        if (!symbol.IsNative() || !symbol.HasAttribute<BatchedReleaseAttribute>())
+            return false;
+
+        method = symbol;
+        return true;
+    }
+
     public static bool IsFlag(this EnumDeclarationSyntax node, ICompilationProvider provider)
     {
         return node.HasAttribute<FlagsAttribute>(provider);
@@ -592,7 +592,8 @@ public class CSharpValidationContextBase<TLanguageConversion> : CSharpValidation
 /// <summary>
 /// CSharp language specific validation context
 ///
-/// It does no default validation
+/// It does no default constructs validation, it just validates the
+/// usage of binding attributes that are shared by all conversions
 /// </summary>
 /// <remarks>This class is for infrastructure only. It's bound to a generic LanguageConversion</remarks>
 public abstract class CSharpValidationContextBase : ValidationContext<CSharpNodeVisitor>
@@ -605,6 +606,17 @@ public abstract class CSharpValidationContextBase : ValidationContext<CSharpNode
     private void CSharpValidationContextBase_Initialized(CSharpNodeVisitor visitor)
     {
         visitor.BeforeNodeVisit += Visitor_BeforeNodeVisit;
+        visitor.MethodDeclarationVisit += Visitor_MethodDeclarationVisit;
+    }
+
+    private void Visitor_MethodDeclarationVisit(CSharpNodeVisitor visitor, MethodDeclarationSyntax node)
+    {
+        var symbol = node.GetDeclaredSymbol<IMethodSymbol>(this);
+        if (symbol.HasAttribute<BatchedReleaseAttribute>() && !isReleaseMethod(symbol))
+            Unsupported(node, "[BatchedRelease] requires an extern void method with a single IntPtr parameter");
+
+        if (symbol.HasAttribute<BackgroundReleaseAttribute>() && !isReleaseMethod(symbol))
+            Unsupported(node, "[BackgroundRelease] requires an extern void method with a single IntPtr parameter");
     }
 
     private void Visitor_BeforeNodeVisit(NodeVisitor visitor, SyntaxNode node, NodeVisitorToken token)
@@ -615,6 +627,13 @@ public abstract class CSharpValidationContextBase : ValidationContext<CSharpNode
             return;
         }
     }
+
+    static bool isReleaseMethod(IMethodSymbol method)
+    {
+        return method.IsNative() && method.ReturnsVoid && method.Parameters.Length == 1
+            && method.Parameters[0].Type.SpecialType == SpecialType.System_IntPtr
+            && method.Parameters[0].RefKind == RefKind.None;
+    }
 }
 
 class CSharpValidationContextBaseImpl : CSharpValidationContextBase<LanguageConversion>
@@ -16,6 +16,11 @@ public class ConversionCSharpToJNI : CSharpLanguageConversionBase<JNICompilation
         return new JNICompilationContext(this);
     }
 
+    protected override CSharpValidationContextBase? CreateValidationContext()
+    {
+        return new JNIValidationContext(this);
+    }
+
     public override IReadOnlyList<string> PreprocessorDefinitions
     {
         get { return new string[] { "JVM", "JNI", "JNI_JDK", "JNI_ANDROID" }; }
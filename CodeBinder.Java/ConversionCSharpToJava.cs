@@ -101,6 +101,9 @@ public class ConversionCSharpToJava : CSharpLanguageConversion
             yield return new JavaVerbatimConversionWriter(nameof(JavaClasses.HandledObject), JavaClasses.HandledObject);
             yield return new JavaVerbatimConversionWriter(nameof(JavaClasses.HandledObjectFinalizer), JavaClasses.HandledObjectFinalizer);
             yield return new JavaVerbatimConversionWriter(nameof(JavaClasses.IObjectFinalizer), JavaClasses.IObjectFinalizer);
+            yield return new JavaVerbatimConversionWriter(nameof(JavaClasses.HandleReleaseQueue), JavaClasses.HandleReleaseQueue);
+            yield return new JavaVerbatimConversionWriter(nameof(JavaClasses.HandledObjectCache), JavaClasses.HandledObjectCache);
+            yield return new StringConversionWriter("proguard-rules.pro", () => JavaClasses.ProguardRules);
             yield return new JavaInteropBoxWriter(JavaInteropType.Boolean);
             yield return new JavaInteropBoxWriter(JavaInteropType.Byte);
             yield return new JavaInteropBoxWriter(JavaInteropType.Short);
@@ -1,5 +1,6 @@
 ﻿// SPDX-FileCopyrightText: (C) 2018 Francesco Pretto <ceztko@gmail.com>
 // SPDX-License-Identifier: MIT
+using CodeBinder.Attributes;
 using System.Text;
 
 namespace CodeBinder.JNI;
@@ -11,6 +12,14 @@ static class JNIMethodExtensions
         return getJNIMethodName(method.GetName(), method, module);
     }
 
+    /// <summary>
+    /// Name of the bulk entry point of a [BatchedRelease] method
+    /// </summary>
+    public static string GetJNIBatchedReleaseMethodName(this MethodDeclarationSyntax method, JNIModuleContext module)
+    {
+        return getJNIMethodName($"{method.GetName()}Batch", method, module);
+    }
+
     static string getJNIMethodName(string methodName, MethodDeclarationSyntax method, JNIModuleContext module)
     {
         var parentType = method.Parent!.GetDeclaredSymbol(module)!;
@@ -22,6 +31,102 @@ static class JNIMethodExtensions
         return builder.ToString();
     }
 
+    /// <summary>
+    /// True if the array parameter is accessed in a JNI critical region
+    /// </summary>
+    public static bool IsCriticalArray(this IParameterSymbol parameter)
+    {
+        return parameter.Type.TypeKind == TypeKind.Array
+            && (parameter.HasAttribute<CriticalArrayAttribute>()
+                || parameter.ContainingSymbol.HasAttribute<CriticalArrayAttribute>());
+    }
+
+    /// <summary>
+    /// Binary name of the Java class declaring the native method, eg. "ns/Outer$Inner"
+    /// </summary>
+    public static string GetJNIClassName(this MethodDeclarationSyntax method, JNIModuleContext module)
+    {
+        var parentType = method.Parent!.GetDeclaredSymbol(module)!;
+        string mappedns = method.GetMappedNamespaceName(module.Compilation.Conversion.NamespaceMapping,
+            NamespaceNormalization.LowerCase, module);
+        return $"{mappedns.Replace('.', '/')}/{parentType.GetQualifiedName().Replace('.', '$')}";
+    }
+
+    /// <summary>
+    /// Try to get the JNI method descriptor, eg. "(ILjava/lang/String;)V". It's not
+    /// possible for methods with parameters mapped to a generic jobject
+    /// </summary>
+    public static bool TryGetJNISignature(this MethodDeclarationSyntax method, ICompilationProvider provider,
+        [NotNullWhen(true)] out string? signature)
+    {
+        signature = null;
+        var builder = new StringBuilder("(");
+        foreach (var parameter in method.ParameterList.Parameters)
+        {
+            var symbol = parameter.Type!.GetTypeSymbolThrow(provider);
+            var descriptor = getJNIDescriptor(symbol, parameter.IsRef() || parameter.IsOut());
+            if (descriptor == null)
+                return false;
+
+            builder.Append(descriptor);
+        }
+
+        var returnDescriptor = getJNIDescriptor(method.ReturnType.GetTypeSymbolThrow(provider), false);
+        if (returnDescriptor == null)
+            return false;
+
+        builder.Append(')').Append(returnDescriptor);
+        signature = builder.ToString();
+        return true;
+    }
+
+    static string? getJNIDescriptor(ITypeSymbol symbol, bool isByRef)
+    {
+        // cbstringarray maps to a jobjectArray, which is ambiguous
+        if (symbol.GetFullName() == "CodeBinder.cbstringarray")
+            return "[Ljava/lang/String;";
+
+        string jniType = getJNIType(symbol, isByRef);
+        string suffix = string.Empty;
+        if (jniType.EndsWith("Array"))
+        {
+            jniType = jniType.Substring(0, jniType.Length - "Array".Length);
+            suffix = "[";
+        }
+
+        string? descriptor = jniType switch
+        {
+            "void" => "V",
+            "jboolean" => "Z",
+            "jbyte" => "B",
+            "jshort" => "S",
+            "jint" => "I",
+            "jlong" => "J",
+            "jptr" => "J",
+            "jfloat" => "F",
+            "jdouble" => "D",
+            "jstring" => "Ljava/lang/String;",
+            "jBoolean" => "Ljava/lang/Boolean;",
+            "jHandleRef" => "LCodeBinder/HandleRef;",
+            "jByteBuffer" => "Ljava/nio/ByteBuffer;",
+            "jBooleanBox" => "LCodeBinder/BooleanBox;",
+            "jByteBox" => "LCodeBinder/ByteBox;",
+            "jShortBox" => "LCodeBinder/ShortBox;",
+            "jIntegerBox" => "LCodeBinder/IntegerBox;",
+            "jLongBox" => "LCodeBinder/LongBox;",
+            "jFloatBox" => "LCodeBinder/FloatBox;",
+            "jDoubleBox" => "LCodeBinder/DoubleBox;",
+            "jStringBox" => "LCodeBinder/StringBox;",
+            // The Java class of generic objects is unknown
+            _ => null,
+        };
+
+        if (descriptor == null)
+            return null;
+
+        return suffix + descriptor;
+    }
+
     public static string GetJNIType(this ParameterSyntax parameter, ICompilationProvider provider)
     {
         var symbol = parameter.Type!.GetTypeSymbolThrow(provider);
@@ -73,6 +178,12 @@ static class JNIMethodExtensions
                 return "jobject";
             case "CodeBinder.cbstring":
                 return "jstring";
+            case "CodeBinder.cbbuffer":
+                return "jbyteArray";
+            case "CodeBinder.cbstringarray":
+                return "jobjectArray";
+            case "CodeBinder.cbspan":
+                return "jByteBuffer";
             case "CodeBinder.cbbool":
                 return "jboolean";
             case "CodeBinder.cboptbool":
@@ -16,6 +16,7 @@ class JNIMethodInitConversion : ConversionWriter
 
     protected override void write(CodeBuilder builder)
     {
+        builder.AppendLine("#include \"Internal/JNIShared.h\"");
         foreach (var module in _compilation.Modules)
             builder.Append("#include \"JNI").Append(module.Name).AppendLine(".h\"");
 
@@ -36,6 +37,8 @@ class JNIMethodInitConversion : ConversionWriter
                         builder.Append("#ifdef").Space().Append(condition).AppendLine();
                     }
                     builder.Append("(void *)").Append(method.GetJNIMethodName(module)).AppendLine(",");
+                    if (method.HasAttribute<BatchedReleaseAttribute>(_compilation))
+                        builder.Append("(void *)").Append(method.GetJNIBatchedReleaseMethodName(module)).AppendLine(",");
                     if (condition != null)
                         builder.Append("#endif //").Space().Append(condition).AppendLine();
                 }
@@ -43,6 +46,104 @@ class JNIMethodInitConversion : ConversionWriter
         }
 
         builder.Append("}").EndOfLine();
+
+        writeNativesTables(builder);
+
+        builder.AppendLine();
+        builder.AppendLine("#include <CBInterop.hpp>");
+        builder.AppendLine();
+        builder.AppendLine("// Snapshot of the trampoline call statistics, see CBTrampolineStats.hpp.");
+        builder.AppendLine("// No trampoline is listed unless compiled with CB_TRAMPOLINE_STATS");
+        builder.AppendLine("extern \"C\" JNIEXPORT size_t CB_JNIGetTrampolineStats(CBTrampolineStats* stats, size_t count)");
+        builder.AppendLine("{");
+        builder.AppendLine("    return cb::GetTrampolineStats(stats, count);");
+        builder.AppendLine("}");
+        builder.AppendLine();
+        builder.AppendLine("""
+#include <CBReclaimer.hpp>
+
+// Snapshot of the background reclamation queue, see CBReclaimer.hpp
+extern "C" JNIEXPORT void CB_JNIGetReclaimerStats(CBReclaimerStats* stats)
+{
+    cb::GetReclaimerStats(*stats);
+}
+""");
+    }
+
+    void writeNativesTables(CodeBuilder builder)
+    {
+        // Group the registrable trampolines by declaring Java class, also
+        // merging partial classes that may span different modules
+        var classes = new Dictionary<string, List<(string JavaName, string Name, string Signature, string? Condition)>>();
+        foreach (var module in _compilation.Modules)
+        {
+            foreach (var method in module.Methods)
+            {
+                if (!method.TryGetJNISignature(module, out var signature))
+                    continue;
+
+                string? condition = null;
+                if (method.TryGetAttribute<ConditionAttribute>(_compilation, out var attr))
+                    condition = attr.GetConstructorArgument<string>(0);
+
+                string className = method.GetJNIClassName(module);
+                if (!classes.TryGetValue(className, out var methods))
+                {
+                    methods = new();
+                    classes.Add(className, methods);
+                }
+
+                methods.Add((method.GetName(), method.GetJNIMethodName(module), signature, condition));
+                if (method.HasAttribute<BatchedReleaseAttribute>(_compilation))
+                    methods.Add(($"{method.GetName()}Batch", method.GetJNIBatchedReleaseMethodName(module), "([JI)V", condition));
+            }
+        }
+
+        var tableNames = new List<(string ClassName, string TableName)>();
+        foreach (var pair in classes)
+        {
+            string tableName = $"s_{pair.Key.Replace('/', '_').Replace('$', '_')}Natives";
+            tableNames.Add((pair.Key, tableName));
+            builder.AppendLine();
+            builder.Append("static const JNINativeMethod").Space().Append(tableName).AppendLine("[] = {");
+            using (builder.Indent())
+            {
+                foreach (var method in pair.Value)
+                {
+                    if (method.Condition != null)
+                        builder.Append("#ifdef").Space().Append(method.Condition).AppendLine();
+
+                    builder.Append("{ (char*)\"").Append(method.JavaName).Append("\", (char*)\"")
+                        .Append(method.Signature).Append("\", (void*)").Append(method.Name).AppendLine(" },");
+                    if (method.Condition != null)
+                        builder.Append("#endif //").Space().Append(method.Condition).AppendLine();
+                }
+
+                // Terminator, so the table is never empty when all entries are conditional
+                builder.AppendLine("{ nullptr, nullptr, nullptr }");
+            }
+
+            builder.Append("}").EndOfLine();
+        }
+
+        builder.AppendLine();
+        builder.AppendLine("// Bind the trampolines to their Java classes, called in JNI_OnLoad.");
+        builder.AppendLine("// Returns false with a pending exception on failure");
+        builder.AppendLine("bool CB_JNIRegisterNatives(JNIEnv* env)");
+        builder.AppendLine("{");
+        using (builder.Indent())
+        {
+            foreach (var table in tableNames)
+            {
+                builder.Append("if (!RegisterClassNatives(env, \"").Append(table.ClassName).Append("\",").Space()
+                    .Append(table.TableName).Append(", sizeof(").Append(table.TableName).Append(") / sizeof(JNINativeMethod) - 1))").AppendLine();
+                builder.IndentChild().Append("return false").EndOfLine().Close();
+                builder.AppendLine();
+            }
+
+            builder.Append("return true").EndOfLine();
+        }
+        builder.AppendLine("}");
     }
 
     protected override string GetGeneratedPreamble() => ConversionCSharpToJNI.SourcePreamble;
@@ -1,5 +1,7 @@
 ﻿// SPDX-FileCopyrightText: (C) 2020 Francesco Pretto <ceztko@gmail.com>
 // SPDX-License-Identifier: MIT
+using CodeBinder.Attributes;
+
 namespace CodeBinder.JNI;
 
 class JNITrampolineMethodWriter : CodeWriter<MethodDeclarationSyntax, JNIModuleConversion>
@@ -17,7 +19,8 @@ class JNITrampolineMethodWriter : CodeWriter<MethodDeclarationSyntax, JNIModuleC
         if (ConversionType == ConversionType.Implementation)
             Builder.Append("extern \"C\"").Space();
 
-        Builder.Append("JNIEXPORT").Space();
+        // Methods that can't be registered must be still resolved by symbol name
+        Builder.Append(Item.TryGetJNISignature(Context, out _) ? "CB_JNI_TRAMPOLINE" : "JNIEXPORT").Space();
         Builder.Append(ReturnType).Space();
         Builder.Append("JNICALL").Space();
         Builder.Append(MethodName).AppendLine("(");
@@ -46,8 +49,38 @@ class JNITrampolineMethodWriter : CodeWriter<MethodDeclarationSyntax, JNIModuleC
         Builder.AppendLine("(void)jenv;");
         Builder.AppendLine("(void)jcls;");
 
-        bool closeBuilder = false;
+        // Call instrumentation, compiled only with CB_TRAMPOLINE_STATS
+        Builder.AppendLine($"CB_TRAMPOLINE_PROBE(\"{Item.GetCLangMethodName()}\");");
+
         var returnTypeSym = Item.ReturnType.GetTypeSymbolThrow(Context);
+        foreach (var param in Item.ParameterList.Parameters)
+        {
+            var symbol = param.GetDeclaredSymbol<IParameterSymbol>(Context);
+            if (symbol.Type.GetFullName() != "CodeBinder.cbspan")
+                continue;
+
+            // Don't call the native function if the buffer can't be wrapped
+            // e.g. auto data_ = DBJ2N(jenv, data);
+            Builder.Append($"auto {param.Identifier.Text}_ = DBJ2N").Parenthesized().Append("jenv").CommaSeparator().Append(param.Identifier.Text).Close().EndOfLine();
+            Builder.Append($"if ({param.Identifier.Text}_.data == nullptr && jenv->ExceptionCheck())").AppendLine();
+            Builder.IndentChild().Append(returnTypeSym.SpecialType == SpecialType.System_Void ? "return" : "return { }").EndOfLine().Close();
+        }
+
+        bool closeBuilder = false;
+        if (needScratchScope())
+        {
+            // Transient strings are allocated in the scratch arena,
+            // which is recycled when the scope exits
+            Builder.AppendLine("cb::ScratchScope scratch_;");
+        }
+
+        bool cachedString = Item.HasAttribute<CachedStringAttribute>(Context);
+        if (cachedString)
+        {
+            // Per method counters of the cache of returned strings
+            Builder.AppendLine($"static JStringCacheStats cacheStats_(\"{Item.GetCLangMethodName()}\");");
+        }
+
         if (returnTypeSym.SpecialType != SpecialType.System_Void)
         {
             var fullName = returnTypeSym.GetFullName();
@@ -70,8 +103,31 @@ class JNITrampolineMethodWriter : CodeWriter<MethodDeclarationSyntax, JNIModuleC
                     }
                     else if (returnTypeSym.GetFullName() == "CodeBinder.cbstring")
                     {
-                        // e.g. return SN2J(ENTextFieldGetText(field), jenv);
-                        Builder.Append("SN2J").Parenthesized(false).Append("jenv").CommaSeparator();
+                        // e.g. return SN2J(jenv, ENTextFieldGetText(field));
+                        // or return CSN2J(jenv, cacheStats_, ENTextFieldGetText(field));
+                        Builder.Append(cachedString ? "CSN2J" : "SN2J")
+                            .Parenthesized(false).Append("jenv").CommaSeparator();
+                        if (cachedString)
+                            Builder.Append("cacheStats_").CommaSeparator();
+
+                        closeBuilder = true;
+                    }
+                    else if (returnTypeSym.GetFullName() == "CodeBinder.cbbuffer")
+                    {
+                        // e.g. return BN2J(jenv, ENDocGetData(doc));
+                        Builder.Append("BN2J").Parenthesized(false).Append("jenv").CommaSeparator();
+                        closeBuilder = true;
+                    }
+                    else if (returnTypeSym.GetFullName() == "CodeBinder.cbspan")
+                    {
+                        // e.g. return DBN2J(jenv, ENDocMapData(doc));
+                        Builder.Append("DBN2J").Parenthesized(false).Append("jenv").CommaSeparator();
+                        closeBuilder = true;
+                    }
+                    else if (returnTypeSym.GetFullName() == "CodeBinder.cbstringarray")
+                    {
+                        // e.g. return SAN2J(jenv, ENDocGetFontNames(doc));
+                        Builder.Append("SAN2J").Parenthesized(false).Append("jenv").CommaSeparator();
                         closeBuilder = true;
                     }
 
@@ -93,7 +149,7 @@ class JNITrampolineMethodWriter : CodeWriter<MethodDeclarationSyntax, JNIModuleC
                     case TypeKind.Array:
                     {
                         bool commit = symbol.HasAttribute<OutAttribute>();
-                        Builder.Append("AJ2N").Parenthesized().Append("jenv")
+                        Builder.Append(symbol.IsCriticalArray() ? "AJ2NCritical" : "AJ2N").Parenthesized().Append("jenv")
                             .CommaSeparator().Append(param.Identifier.Text)
                             .CommaSeparator().Append(commit ? "true" : "false")
                             .Close();
@@ -199,6 +255,12 @@ class JNITrampolineMethodWriter : CodeWriter<MethodDeclarationSyntax, JNIModuleC
                                     Builder.Append(param.Identifier.Text);
                                 break;
                             }
+                            case "CodeBinder.cbspan":
+                            {
+                                // Converted before the call, e.g. data_
+                                Builder.Append(param.Identifier.Text).Append("_");
+                                break;
+                            }
                             case "CodeBinder.cboptbool":
                             {
                                 Builder.Append("OPTJ2N")
@@ -253,4 +315,60 @@ class JNITrampolineMethodWriter : CodeWriter<MethodDeclarationSyntax, JNIModuleC
     {
         get { return Item.GetJNIMethodName(Context.Context); }
     }
+
+    // Converted string parameters are allocated in the arena, as well as
+    // returned strings built with cb::ScratchString, which are converted
+    // before the scope exits
+    bool needScratchScope()
+    {
+        if (Item.ReturnType.GetTypeSymbolThrow(Context).GetFullName() == "CodeBinder.cbstring")
+            return true;
+
+        foreach (var param in Item.ParameterList.Parameters)
+        {
+            if (param.Type!.GetTypeSymbolThrow(Context).GetFullName() == "CodeBinder.cbstring")
+                return true;
+        }
+
+        return false;
+    }
+}
+
+/// <summary>
+/// Bulk entry point of a [BatchedRelease] method, eg. SLFreeDocumentBatch(long[] handles, int count)
+/// </summary>
+class JNIBatchedReleaseMethodWriter : CodeWriter<MethodDeclarationSyntax, JNIModuleConversion>
+{
+    public ConversionType ConversionType { get; private set; }
+
+    public JNIBatchedReleaseMethodWriter(MethodDeclarationSyntax method, JNIModuleConversion module, ConversionType conversionType)
+        : base(method, module)
+    {
+        ConversionType = conversionType;
+    }
+
+    protected override void Write()
+    {
+        if (ConversionType == ConversionType.Implementation)
+            Builder.Append("extern \"C\"").Space();
+
+        Builder.Append("CB_JNI_TRAMPOLINE void JNICALL").Space();
+        Builder.Append(Item.GetJNIBatchedReleaseMethodName(Context.Context)).AppendLine("(");
+        using (Builder.Indent())
+            Builder.Append("JNIEnv *jenv, jclass jcls, jlongArray handles, jint count)");
+
+        if (ConversionType == ConversionType.Implementation)
+        {
+            using (Builder.AppendLine().Block())
+            {
+                Builder.AppendLine("(void)jcls;");
+                Builder.AppendLine($"CB_TRAMPOLINE_PROBE(\"{Item.GetCLangMethodName()}Batch\");");
+                Builder.AppendLine($"ReleaseHandlesJ2N(jenv, handles, count, {Item.GetCLangMethodName()});");
+            }
+        }
+        else
+        {
+            Builder.EndOfLine();
+        }
+    }
 }
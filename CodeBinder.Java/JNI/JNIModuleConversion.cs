@@ -101,6 +101,11 @@ public class JNIModuleConversion : TypeConversion<JNIModuleContext, JNICompilati
             else
             {
                 builder.Append(new JNITrampolineMethodWriter(method, this, conversionType));
+                if (method.HasAttribute<BatchedReleaseAttribute>(this))
+                {
+                    builder.AppendLine();
+                    builder.Append(new JNIBatchedReleaseMethodWriter(method, this, conversionType));
+                }
             }
 
             if (condition != null)
@@ -0,0 +1,92 @@
+﻿// SPDX-FileCopyrightText: (C) 2024 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: MIT
+
+using CodeBinder.Attributes;
+
+namespace CodeBinder.JNI;
+
+class JNIValidationContext : CSharpValidationContextBase<ConversionCSharpToJNI>
+{
+    public JNIValidationContext(ConversionCSharpToJNI conversion)
+        : base(conversion)
+    {
+        Init += JNIValidationContext_Init;
+    }
+
+    private void JNIValidationContext_Init(CSharpNodeVisitor visitor)
+    {
+        visitor.MethodDeclarationVisit += Visitor_MethodDeclarationVisit;
+    }
+
+    private void Visitor_MethodDeclarationVisit(CSharpNodeVisitor visitor, MethodDeclarationSyntax node)
+    {
+        var symbol = node.GetDeclaredSymbol<IMethodSymbol>(this);
+        if (symbol.HasAttribute<CachedStringAttribute>() && symbol.ReturnType.GetFullName() != "CodeBinder.cbstring")
+            Unsupported(node, "[CachedString] requires a cbstring return value");
+
+        bool critical = symbol.HasAttribute<CriticalArrayAttribute>();
+        foreach (var parameter in symbol.Parameters)
+        {
+            if (!parameter.HasAttribute<CriticalArrayAttribute>())
+                continue;
+
+            if (parameter.Type.TypeKind != TypeKind.Array)
+                Unsupported(node, $"[CriticalArray] parameter {parameter.Name} is not an array");
+
+            critical = true;
+        }
+
+        if (!critical)
+            return;
+
+        if (!symbol.IsNative())
+        {
+            Unsupported(node, "[CriticalArray] is supported only in extern methods");
+            return;
+        }
+
+        // No JNI function can be called while a critical region is open, which
+        // includes the marshaling of the other arguments and of the return value.
+        // Objects could also be used by the native code to call back into Java
+        foreach (var parameter in node.ParameterList.Parameters)
+        {
+            var parameterSymbol = parameter.GetDeclaredSymbol<IParameterSymbol>(this);
+            if (parameterSymbol.Type.TypeKind == TypeKind.Array)
+            {
+                if (!parameterSymbol.IsCriticalArray())
+                {
+                    Unsupported(node, $"[CriticalArray] requires all array parameters to be critical, "
+                        + $"{parameter.Identifier.Text} is not");
+                }
+            }
+            else if (!isPrimitiveJNIType(parameter.GetJNIType(this)))
+            {
+                Unsupported(node, $"[CriticalArray] parameter {parameter.Identifier.Text} requires JNI "
+                    + "marshaling or may call back into Java");
+            }
+        }
+
+        string returnType = node.GetJNIReturnType(this);
+        if (returnType != "void" && !isPrimitiveJNIType(returnType))
+            Unsupported(node, "[CriticalArray] return value requires JNI marshaling");
+    }
+
+    static bool isPrimitiveJNIType(string jniType)
+    {
+        switch (jniType)
+        {
+            case "jboolean":
+            case "jbyte":
+            case "jchar":
+            case "jshort":
+            case "jint":
+            case "jlong":
+            case "jfloat":
+            case "jdouble":
+            case "jptr":
+                return true;
+            default:
+                return false;
+        }
+    }
+}
@@ -4,6 +4,8 @@
  */
 
 #include "JNITypes.h"
+#include <CBInterop.h>
+#include <CBReclaimer.hpp>
 
 extern "C"
 {
@@ -42,4 +44,16 @@ extern "C"
     {
         return (jobject)env->NewLocalRef((jobject)weakRef);
     }
+
+    JNIEXPORT void JNICALL Java_CodeBinder_BinderUtils_freeMemory(
+        JNIEnv*, jclass, jlong ptr)
+    {
+        CBFreeMemory((void*)ptr);
+    }
+
+    JNIEXPORT void JNICALL Java_CodeBinder_BinderUtils_setFinalizerThread(
+        JNIEnv*, jclass)
+    {
+        cb::SetReclaimerFinalizerThread();
+    }
 }
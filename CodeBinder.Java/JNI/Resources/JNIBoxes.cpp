@@ -4,41 +4,25 @@
  */
 
 #include "JNIBoxes.h"
+#include "JNIShared.h"
 
 #include <CBInterop.h>
 
 SBJ2N::SBJ2N(JNIEnv* env, jStringBox box)
     : m_env(env), m_box(box)
 {
-    m_jstring = box->GetValue(env);
-    if (m_jstring == nullptr)
-    {
-        m_chars = nullptr;
-        m_isCopy = false;
-        m_value = { };
-    }
-    else
-    {
-        m_chars = m_env->GetStringUTFChars(m_jstring, &m_isCopy);
-        jsize length = env->GetStringUTFLength(m_jstring);
-        m_value = CBCreateStringViewLen(m_chars, (size_t)length);
-    }
+    m_buffer = CreateCBString(env, box->GetValue(env));
+    // The callee receives a non owning view, that it may replace
+    m_value = CBCreateStringViewLen(m_buffer.data, CBSLEN(m_buffer));
 }
 
 SBJ2N::~SBJ2N()
 {
-    if (m_value.data != m_chars)
-    {
-        if (m_value.data == nullptr)
-            m_box->SetValue(m_env, nullptr);
-        else
-            m_box->SetValue(m_env, m_env->NewStringUTF(m_value.data));
-    }
-
-    if (m_isCopy)
-        m_env->ReleaseStringUTFChars(m_jstring, m_chars);
+    if (m_value.data != m_buffer.data)
+        m_box->SetValue(m_env, CreateJString(m_env, m_value));
 
     CBFreeString(&m_value);
+    CBFreeString(&m_buffer);
 }
 
 BJ2NImpl<_jBooleanBox> BJ2N(JNIEnv * env, jBooleanBox box)
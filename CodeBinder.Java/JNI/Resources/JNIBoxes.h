@@ -43,9 +43,7 @@ public:
 private:
     JNIEnv* m_env;
     jStringBox m_box;
-    jstring m_jstring;
-    const char* m_chars;
-    jboolean m_isCopy;
+    cbstring m_buffer;
     cbstring m_value;
 };
 
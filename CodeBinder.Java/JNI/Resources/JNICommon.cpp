@@ -5,18 +5,20 @@
 
 #include "JNICommon.h"
 #include <utility>
+#include <algorithm>
 #include <string>
 #include <cassert>
 #include <CBInterop.h>
 
 using namespace std;
 
+#ifndef CB_JNI_LOCAL_FRAME_CHUNK
+// Number of elements converted within a single local reference frame
+#define CB_JNI_LOCAL_FRAME_CHUNK 128
+#endif // CB_JNI_LOCAL_FRAME_CHUNK
+
 SJ2N::SJ2N(JNIEnv* env, jstring str)
-    : m_env(env), m_string(str), m_chars(nullptr), m_isCopy(false)
-{
-    if (m_string != nullptr)
-        m_chars = m_env->GetStringUTFChars(m_string, &m_isCopy);
-}
+    : m_value(CreateCBString(env, str)) { }
 
 SN2J::SN2J(JNIEnv* env, const cbstring& str)
     : m_handled(false), m_env(env), m_string(str) { }
@@ -30,17 +32,13 @@ SN2J::SN2J(JNIEnv* env, cbstring&& str)
 
 SJ2N::~SJ2N()
 {
-    if (m_isCopy)
-        m_env->ReleaseStringUTFChars(m_string, m_chars);
+    CBFreeString(&m_value);
 }
 
 SJ2N::operator cbstring() const
 {
-    if (m_string == nullptr)
-        return { };
-
-    jsize length = m_env->GetStringUTFLength(m_string);
-    return CBCreateStringViewLen(m_chars, (size_t)length);
+    // The callee just borrows the string
+    return CBCreateStringViewLen(m_value.data, CBSLEN(m_value));
 }
 
 SN2J::~SN2J()
@@ -51,10 +49,108 @@ SN2J::~SN2J()
 
 SN2J::operator jstring() const
 {
-    if (m_string.data == nullptr)
+    return CreateJString(m_env, m_string);
+}
+
+jstring CSN2J(JNIEnv* env, JStringCacheStats& stats, cbstring str)
+{
+    jstring ret = GetCachedJString(env, str, stats);
+    CBFreeString(&str);
+    return ret;
+}
+
+jbyteArray BN2J(JNIEnv* env, cbbuffer buf)
+{
+    if (buf.data == nullptr)
+        return nullptr;
+
+    // Buffers of any element kind are exposed as raw bytes
+    jsize size = (jsize)CBBufferGetByteSize(&buf);
+    CB_TRAMPOLINE_BYTES((size_t)size);
+    jbyteArray ret = env->NewByteArray(size);
+    if (ret != nullptr)
+        env->SetByteArrayRegion(ret, 0, size, (const jbyte*)buf.data);
+
+    CBFreeBuffer(&buf);
+    return ret;
+}
+
+jobjectArray SAN2J(JNIEnv* env, cbstringarray arr)
+{
+    if (arr.data == nullptr)
+        return nullptr;
+
+    jsize count = (jsize)CBStringArrayGetCount(&arr);
+    jclass stringClass = env->FindClass("java/lang/String");
+    jobjectArray ret = env->NewObjectArray(count, stringClass, nullptr);
+    env->DeleteLocalRef(stringClass);
+    if (ret != nullptr)
+    {
+        // Convert the elements in chunks, each one within its own
+        // local frame, so the intermediate strings are released in
+        // bulk without exhausting the local reference table
+        for (jsize i = 0; i < count; i += CB_JNI_LOCAL_FRAME_CHUNK)
+        {
+            jsize end = std::min(count, i + CB_JNI_LOCAL_FRAME_CHUNK);
+            if (env->PushLocalFrame(end - i) != JNI_OK)
+            {
+                // OutOfMemoryError is pending
+                env->DeleteLocalRef(ret);
+                ret = nullptr;
+                break;
+            }
+
+            for (jsize j = i; j < end; j++)
+                env->SetObjectArrayElement(ret, j, CreateJString(env, CBStringArrayGet(&arr, (size_t)j)));
+
+            env->PopLocalFrame(nullptr);
+        }
+    }
+
+    CBFreeStringArray(&arr);
+    return ret;
+}
+
+cbspan DBJ2N(JNIEnv* env, jByteBuffer buffer)
+{
+    if (buffer == nullptr)
+        return cbspannull;
+
+    auto data = (uint8_t*)env->GetDirectBufferAddress(buffer);
+    if (data == nullptr)
+    {
+        // Heap buffers can't be accessed without copying. The
+        // trampoline returns without calling the native function
+        // and the exception is thrown when returning to Java
+        jclass exClass = env->FindClass("java/lang/IllegalArgumentException");
+        env->ThrowNew(exClass, "Not a direct buffer");
+        env->DeleteLocalRef(exClass);
+        return cbspannull;
+    }
+
+    // The span covers the remaining elements, as for NIO channels
+    jint position;
+    jint limit;
+    GetBufferRange(env, buffer, position, limit);
+    return CBCreateSpanView(data + position, (size_t)(limit - position));
+}
+
+jByteBuffer DBN2J(JNIEnv* env, cbspan span)
+{
+    if (span.data == nullptr)
         return nullptr;
 
-    return m_env->NewStringUTF(m_string.data);
+    jByteBuffer ret = env->NewDirectByteBuffer(span.data, (jlong)CBSPLEN(span));
+    if (ret == nullptr)
+    {
+        CBFreeSpan(&span);
+        return nullptr;
+    }
+
+    if ((span.opaque & CB_BUFFER_OWNSDATA_FLAG) != 0)
+        RegisterDirectBuffer(env, ret, span.data);
+
+    return ret;
 }
 
 AJ2NImpl<jbyteArray, jbyte, uint8_t, int8_t> AJ2N(JNIEnv* env, jbyteArray jarray, bool commit)
@@ -91,3 +187,38 @@ AJ2NImpl<jptrArray, void*> AJ2N(JNIEnv* env, jptrArray jarray, bool commit)
 {
     return AJ2NImpl<jptrArray, void*>(env, jarray, commit);
 }
+
+AJ2NImpl<jbyteArray, jbyte, uint8_t, int8_t> AJ2NCritical(JNIEnv* env, jbyteArray jarray, bool commit)
+{
+    return AJ2NImpl<jbyteArray, jbyte, uint8_t, int8_t>(env, jarray, commit, true);
+}
+
+AJ2NImpl<jshortArray, jshort, uint16_t, int16_t> AJ2NCritical(JNIEnv* env, jshortArray jarray, bool commit)
+{
+    return AJ2NImpl<jshortArray, jshort, uint16_t, int16_t>(env, jarray, commit, true);
+}
+
+AJ2NImpl<jintArray, jint, uint32_t, int32_t> AJ2NCritical(JNIEnv* env, jintArray jarray, bool commit)
+{
+    return AJ2NImpl<jintArray, jint, uint32_t, int32_t>(env, jarray, commit, true);
+}
+
+AJ2NImpl<jlongArray, jlong, uint64_t, int64_t> AJ2NCritical(JNIEnv* env, jlongArray jarray, bool commit)
+{
+    return AJ2NImpl<jlongArray, jlong, uint64_t, int64_t>(env, jarray, commit, true);
+}
+
+AJ2NImpl<jfloatArray, jfloat, float> AJ2NCritical(JNIEnv* env, jfloatArray jarray, bool commit)
+{
+    return AJ2NImpl<jfloatArray, jfloat, float>(env, jarray, commit, true);
+}
+
+AJ2NImpl<jdoubleArray, jdouble, double> AJ2NCritical(JNIEnv* env, jdoubleArray jarray, bool commit)
+{
+    return AJ2NImpl<jdoubleArray, jdouble, double>(env, jarray, commit, true);
+}
+
+AJ2NImpl<jptrArray, void*> AJ2NCritical(JNIEnv* env, jptrArray jarray, bool commit)
+{
+    return AJ2NImpl<jptrArray, void*>(env, jarray, commit, true);
+}
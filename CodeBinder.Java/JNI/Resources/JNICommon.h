@@ -7,12 +7,13 @@
 
 #include <jni.h>
 #include <stdexcept>
+#include <type_traits>
 #include "JNIShared.h"
 #include "JNIBoxes.h"
 #include "JNIOptional.h"
-#include <CBBaseTypes.h>
+#include <CBInterop.hpp>
 
- // Wraps jstring and convert to utf-16 chars
+ // Wraps jstring and convert to utf-8 chars
 class SJ2N
 {
 public:
@@ -21,10 +22,7 @@ public:
 public:
     operator cbstring() const;
 private:
-    JNIEnv* m_env;
-    jstring m_string;
-    const char* m_chars;
-    jboolean m_isCopy;
+    cbstring m_value;
 };
 
 // Wraps utf-16 chars and convert to jstring
@@ -42,6 +40,26 @@ private:
     cbstring m_string;
 };
 
+// Convert to a jstring through the cache of returned strings,
+// counting in the stats of the calling method, releasing the
+// string if owned
+jstring CSN2J(JNIEnv* env, JStringCacheStats& stats, cbstring str);
+
+// Copy the buffer to a java byte array, releasing it if owned
+jbyteArray BN2J(JNIEnv* env, cbbuffer buf);
+
+// Convert to a java string array, releasing it if owned
+jobjectArray SAN2J(JNIEnv* env, cbstringarray arr);
+
+// Wrap the memory of a direct java.nio.ByteBuffer, without copying.
+// The span covers the elements between the buffer position and limit.
+// Heap buffers throw IllegalArgumentException and return a null span
+cbspan DBJ2N(JNIEnv* env, jByteBuffer buffer);
+
+// Wrap the memory in a direct java.nio.ByteBuffer, without copying.
+// Owned memory is released when the buffer is collected
+jByteBuffer DBN2J(JNIEnv* env, cbspan span);
+
 // Adapter class to link correct JNI methods
 template <typename TJArray, typename TNArray>
 struct AJNIShim
@@ -66,24 +84,38 @@ struct AJNIShim
 template <typename TJArray, typename TNArray, typename... Args>
 class AJ2NImpl;
 
-// Wraps java array and convert to native one
+// Wraps java array and convert to native one. When critical, the array
+// is accessed in a critical region, usually without copying it. No other
+// JNI function can be called until the wrapper is destroyed
 template <typename TJArray, typename TNArray>
 class AJ2NImpl<TJArray, TNArray>
 {
 public:
-    AJ2NImpl(JNIEnv* env, TJArray array, bool commit)
+    AJ2NImpl(JNIEnv* env, TJArray array, bool commit, bool critical = false)
     {
         m_env = env;
         m_jarray = array;
         m_commit = commit;
+        // Pointers can be accessed in place only if they have the size of jlong
+        m_critical = critical && (!std::is_pointer_v<TNArray> || sizeof(TNArray) == sizeof(jlong));
         if (array == nullptr)
             m_narray = nullptr;
+        else if (m_critical)
+            m_narray = (TNArray*)env->GetPrimitiveArrayCritical(array, nullptr);
         else
+        {
             m_narray = AJNIShim<TJArray, TNArray>::GetNativeArray(env, array);
+            CB_TRAMPOLINE_BYTES((size_t)env->GetArrayLength(array) * sizeof(TNArray));
+        }
     }
     ~AJ2NImpl()
     {
-        if (m_jarray != nullptr)
+        if (m_jarray == nullptr)
+            return;
+
+        if (m_critical)
+            m_env->ReleasePrimitiveArrayCritical(m_jarray, m_narray, m_commit ? 0 : JNI_ABORT);
+        else
             AJNIShim<TJArray, TNArray>::FreeNativeArray(m_env, m_jarray, m_narray, m_commit);
     }
 public:
@@ -94,6 +126,7 @@ private:
     TJArray m_jarray;
     TNArray* m_narray;
     bool m_commit;
+    bool m_critical;
 };
 
 template <typename TJArray, typename TNArray, typename TCArray, typename... Args>
@@ -229,3 +262,29 @@ AJ2NImpl<jlongArray, jlong, uint64_t, int64_t> AJ2N(JNIEnv* env, jlongArray jarr
 AJ2NImpl<jfloatArray, jfloat, float> AJ2N(JNIEnv* env, jfloatArray jarray, bool commit);
 AJ2NImpl<jdoubleArray, jdouble, double> AJ2N(JNIEnv* env, jdoubleArray jarray, bool commit);
 AJ2NImpl<jptrArray, void*> AJ2N(JNIEnv* env, jptrArray jarray, bool commit);
+AJ2NImpl<jbyteArray, jbyte, uint8_t, int8_t> AJ2NCritical(JNIEnv* env, jbyteArray jarray, bool commit);
+AJ2NImpl<jshortArray, jshort, uint16_t, int16_t> AJ2NCritical(JNIEnv* env, jshortArray jarray, bool commit);
+AJ2NImpl<jintArray, jint, uint32_t, int32_t> AJ2NCritical(JNIEnv* env, jintArray jarray, bool commit);
+AJ2NImpl<jlongArray, jlong, uint64_t, int64_t> AJ2NCritical(JNIEnv* env, jlongArray jarray, bool commit);
+AJ2NImpl<jfloatArray, jfloat, float> AJ2NCritical(JNIEnv* env, jfloatArray jarray, bool commit);
+AJ2NImpl<jdoubleArray, jdouble, double> AJ2NCritical(JNIEnv* env, jdoubleArray jarray, bool commit);
+AJ2NImpl<jptrArray, void*> AJ2NCritical(JNIEnv* env, jptrArray jarray, bool commit);
+
+// Release a batch of handles collected by an HandleReleaseQueue with a single
+// call. The handles are copied in chunks, so the array is never pinned
+template <typename THandle>
+void ReleaseHandlesJ2N(JNIEnv* env, jlongArray handles, jint count, void(*release)(THandle))
+{
+    constexpr jint ChunkSize = 64;
+    jlong chunk[ChunkSize];
+    for (jint i = 0; i < count; i += ChunkSize)
+    {
+        jint size = count - i < ChunkSize ? count - i : ChunkSize;
+        env->GetLongArrayRegion(handles, i, size, chunk);
+        if (env->ExceptionCheck())
+            return;
+
+        for (jint j = 0; j < size; j++)
+            release((THandle)(intptr_t)chunk[j]);
+    }
+}
@@ -21,6 +21,12 @@ protected:
         return TNative{ };
     }
 
+    static const char* getClassName()
+    {
+        static_assert(always_false<TJBoxed, TNative>, "Not implemented");
+        return nullptr;
+    }
+
     static const char* getFieldIdSignature()
     {
         static_assert(always_false<TJBoxed, TNative>, "Not implemented");
@@ -37,7 +43,12 @@ protected:
         return (cbbool)env->GetBooleanField((jobject)boxed, fieldId);
     }
 
-    const char* getFieldIdSignature()
+    static const char* getClassName()
+    {
+        return "java/lang/Boolean";
+    }
+
+    static const char* getFieldIdSignature()
     {
         return "Z";
     }
@@ -57,18 +68,49 @@ public:
         else
         {
             m_Optional.has_value = (cbbool)true;
-            auto cls = env->GetObjectClass((jobject)boxed);
-            auto fieldId = env->GetFieldID(cls, "value", this->getFieldIdSignature());
-            m_Optional.value = this->getValue(env, boxed, fieldId);
+            m_Optional.value = this->getValue(env, boxed, getFieldId(env, boxed));
         }
     }
 
+    static void InitFieldId(JNIEnv* env)
+    {
+        jclass cls = env->FindClass(OPTJ2NImpl::getClassName());
+        if (cls == nullptr)
+        {
+            env->ExceptionClear();
+            return;
+        }
+
+        s_fieldId = env->GetFieldID(cls, "value", OPTJ2NImpl::getFieldIdSignature());
+        if (s_fieldId == nullptr)
+        {
+            // Resolved lazily in getFieldId()
+            env->ExceptionClear();
+        }
+
+        env->DeleteLocalRef(cls);
+    }
+
     operator const TOptional&()
     {
         return m_Optional;
     }
+private:
+    static jfieldID getFieldId(JNIEnv* env, TJBoxed boxed)
+    {
+        if (s_fieldId != nullptr)
+            return s_fieldId;
+
+        auto cls = env->GetObjectClass((jobject)boxed);
+        auto ret = env->GetFieldID(cls, "value", OPTJ2NImpl::getFieldIdSignature());
+        env->DeleteLocalRef(cls);
+        return ret;
+    }
+
 private:
     TOptional m_Optional;
+    // Resolved once in JNI_OnLoad
+    static inline jfieldID s_fieldId;
 };
 
 inline OPTJ2NImpl<cboptbool, jBoolean, cbbool> OPTJ2N(JNIEnv* env, jBoolean boxed)
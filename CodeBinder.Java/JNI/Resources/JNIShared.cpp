@@ -5,21 +5,296 @@
 
 #include <jni.h>
 #include <cassert>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include "JNIShared.h"
+#include "JNIOptional.h"
+#include <CBInterop.hpp>
+#include <CBUnicode.hpp>
 
 #define JNI_VERSION JNI_VERSION_1_6
 
+// Slots of the cache of returned strings, see GetCachedJString()
+#ifndef CB_JNI_STRING_CACHE_SIZE
+#define CB_JNI_STRING_CACHE_SIZE 256
+#endif
+
+// Longer strings are not cached
+#ifndef CB_JNI_STRING_CACHE_MAX_LENGTH
+#define CB_JNI_STRING_CACHE_MAX_LENGTH 256
+#endif
+
+// Longer converted strings are sized exactly, see CreateCBString()
+#ifndef CB_JNI_SCRATCH_WORST_CASE_LENGTH
+#define CB_JNI_SCRATCH_WORST_CASE_LENGTH 64
+#endif
+
 static JavaVM* s_jvm;
 
 static jfieldID handleFieldID;
 
+// BinderUtils.registerDirectBuffer(ByteBuffer, long)
+static jclass s_binderUtilsClass;
+static jmethodID s_registerDirectBufferID;
+
+// Buffer.position() and Buffer.limit()
+static jmethodID s_bufferPositionID;
+static jmethodID s_bufferLimitID;
+
+// Interned strings are immortal, so their jstring can be cached
+// by data pointer for the lifetime of the library
+static std::mutex s_internedMutex;
+static std::unordered_map<const char*, jstring> s_internedStrings;
+
+// Other strings are cached by content. Data pointers can't be used,
+// as the memory may be reused for a different string once released
+struct CachedJString
+{
+    std::string value;
+    jstring jstr;
+};
+static std::mutex s_stringCacheMutex;
+static CachedJString s_stringCache[CB_JNI_STRING_CACHE_SIZE];
+
+// Registered per method counters, see JStringCacheStats
+static std::mutex s_stringCacheStatsMutex;
+static JStringCacheStats* s_stringCacheStats;
+
 static JNIEnv* getEnv(JavaVM* jvm);
+static jstring newString(JNIEnv* env, const cbstring& str);
+static jstring getInternedJString(JNIEnv* env, const cbstring& str);
+static void registerStringCacheStats(JStringCacheStats& stats);
+
+static_assert(sizeof(jchar) == sizeof(uint16_t), "jchar must be a UTF-16 unit");
+
+namespace
+{
+    // Per thread JNIEnv of threads attached here. Threads attached
+    // elsewhere may be detached at any time, so their env is
+    // queried on every call
+    class ThreadEnv final
+    {
+    public:
+        ThreadEnv()
+            : m_jvm(nullptr), m_env(nullptr) { }
+
+        ~ThreadEnv()
+        {
+            if (m_jvm != nullptr)
+                m_jvm->DetachCurrentThread();
+        }
+
+        // Returns nullptr if the thread can't be attached
+        JNIEnv* Get(JavaVM* jvm)
+        {
+            if (m_env != nullptr)
+                return m_env;
+
+            JNIEnv* env;
+            jint rs = jvm->GetEnv((void**)&env, JNI_VERSION);
+            if (rs == JNI_OK)
+                return env;
+
+            if (rs != JNI_EDETACHED)
+                return nullptr;
+
+            // Daemon threads don't prevent the JVM from shutting down
+            JavaVMAttachArgs args = { JNI_VERSION, (char*)"CodeBinder native thread", nullptr };
+#ifdef __ANDROID__
+            rs = jvm->AttachCurrentThreadAsDaemon(&env, &args);
+#else
+            rs = jvm->AttachCurrentThreadAsDaemon((void**)&env, &args);
+#endif
+            if (rs != JNI_OK)
+                return nullptr;
+
+            m_jvm = jvm;
+            m_env = env;
+            return env;
+        }
+    private:
+        JavaVM* m_jvm;
+        JNIEnv* m_env;
+    };
+
+    // Temporary buffer, allocated in the scratch arena when active
+    template <typename T>
+    class TempBuffer final
+    {
+    public:
+        TempBuffer(size_t count)
+            : m_heap(false)
+        {
+            if (count <= StackCount)
+            {
+                m_data = m_stack;
+            }
+            else
+            {
+                m_data = (T*)cb::ScratchArena::Alloc(count * sizeof(T));
+                if (m_data == nullptr)
+                {
+                    m_data = (T*)cb::AllocMemory(count * sizeof(T));
+                    m_heap = true;
+                }
+            }
+        }
+
+        ~TempBuffer()
+        {
+            if (m_heap)
+                cb::FreeMemory(m_data);
+        }
+
+        TempBuffer(const TempBuffer&) = delete;
+        TempBuffer& operator=(const TempBuffer&) = delete;
+
+        T* data() { return m_data; }
+
+    private:
+        static constexpr size_t StackCount = 256;
+        T m_stack[StackCount];
+        T* m_data;
+        bool m_heap;
+    };
+}
 
 jlong GetHandle(JNIEnv* env, jHandleRef handleref)
 {
     return env->GetLongField(handleref, handleFieldID);
 }
 
+jstring CreateJString(JNIEnv* env, const cbstring& str)
+{
+    if (str.data == nullptr)
+        return nullptr;
+
+    CB_TRAMPOLINE_BYTES(CBSLEN(str));
+    if (CBStringIsInterned(&str))
+        return getInternedJString(env, str);
+
+    return newString(env, str);
+}
+
+jstring GetCachedJString(JNIEnv* env, const cbstring& str, JStringCacheStats& stats)
+{
+    if (!stats.Registered.load(std::memory_order_acquire))
+        registerStringCacheStats(stats);
+
+    size_t length = CBSLEN(str);
+    if (str.data == nullptr || CBStringIsInterned(&str) || length > CB_JNI_STRING_CACHE_MAX_LENGTH)
+        return CreateJString(env, str);
+
+    // Direct mapped cache: a colliding string evicts the slot
+    std::string_view value(str.data, length);
+    auto& slot = s_stringCache[std::hash<std::string_view>()(value) % CB_JNI_STRING_CACHE_SIZE];
+    {
+        std::lock_guard<std::mutex> lock(s_stringCacheMutex);
+        if (slot.jstr != nullptr && slot.value == value)
+        {
+            stats.Hits.fetch_add(1, std::memory_order_relaxed);
+            return (jstring)env->NewLocalRef(slot.jstr);
+        }
+    }
+
+    stats.Misses.fetch_add(1, std::memory_order_relaxed);
+    CB_TRAMPOLINE_BYTES(length);
+    jstring ret = newString(env, str);
+    if (ret == nullptr)
+        return nullptr;
+
+    jstring evicted;
+    {
+        std::lock_guard<std::mutex> lock(s_stringCacheMutex);
+        evicted = slot.jstr;
+        slot.value.assign(value);
+        slot.jstr = (jstring)env->NewGlobalRef(ret);
+    }
+
+    if (evicted != nullptr)
+        env->DeleteGlobalRef(evicted);
+
+    return ret;
+}
+
+cbstring CreateCBString(JNIEnv* env, jstring str)
+{
+    if (str == nullptr)
+        return { };
+
+    jsize length = env->GetStringLength(str);
+    TempBuffer<jchar> buffer((size_t)length);
+    env->GetStringRegion(str, 0, length, buffer.data());
+    auto units = (const uint16_t*)buffer.data();
+
+    // Short strings are sized for the worst case to skip the length
+    // pass, which would over-reserve the arena for longer ones
+    size_t utf8Length = (size_t)length <= CB_JNI_SCRATCH_WORST_CASE_LENGTH
+        ? (size_t)length * 3 : cb::Utf16ToUtf8Length(units, (size_t)length);
+
+    cbstring ret;
+    if (cb::ScratchArena::IsActive())
+    {
+        ret = cb::CreateScratchStringFixed(utf8Length);
+    }
+    else
+    {
+        ret = CBCreateStringFixed(utf8Length);
+        if (ret.data == nullptr)
+            throw std::bad_alloc();
+    }
+
+    auto data = (char*)ret.data;
+    size_t written = cb::Utf16ToUtf8(units, (size_t)length, data);
+    data[written] = '\0';
+    ret.opaque = written | (ret.opaque & CB_STRING_FLAGS_MASK);
+    CB_TRAMPOLINE_BYTES(written);
+    return ret;
+}
+
+// Convert to real UTF-16: NewStringUTF expects modified UTF-8 and
+// a null terminated string, which adopted buffers may not be
+jstring newString(JNIEnv* env, const cbstring& str)
+{
+    size_t length = CBSLEN(str);
+    // UTF-16 units are never more than UTF-8 bytes
+    TempBuffer<jchar> buffer(length);
+    size_t units = cb::Utf8ToUtf16(str.data, length, (uint16_t*)buffer.data());
+    return env->NewString(buffer.data(), (jsize)units);
+}
+
+jstring getInternedJString(JNIEnv* env, const cbstring& str)
+{
+    std::lock_guard<std::mutex> lock(s_internedMutex);
+    auto found = s_internedStrings.find(str.data);
+    if (found == s_internedStrings.end())
+    {
+        auto jstr = newString(env, str);
+        if (jstr == nullptr)
+            return nullptr;
+
+        found = s_internedStrings.insert({ str.data, (jstring)env->NewGlobalRef(jstr) }).first;
+        env->DeleteLocalRef(jstr);
+    }
+
+    return (jstring)env->NewLocalRef(found->second);
+}
+
+void registerStringCacheStats(JStringCacheStats& stats)
+{
+    std::lock_guard<std::mutex> lock(s_stringCacheStatsMutex);
+    if (stats.Registered.load(std::memory_order_relaxed))
+        return;
+
+    stats.Next = s_stringCacheStats;
+    s_stringCacheStats = &stats;
+    stats.Registered.store(true, std::memory_order_release);
+}
+
 JNIEnv* GetEnv()
 {
     return getEnv(s_jvm);
@@ -27,13 +302,10 @@ JNIEnv* GetEnv()
 
 JNIEnv* getEnv(JavaVM* jvm)
 {
-    // GetEnv can be used only if current thread was created
-    // with Java, otherwise AttachCurrentProcess should be used
-    // instead
-    JNIEnv* env;
-    jint rs = jvm->GetEnv((void**)&env, JNI_VERSION);
-    assert(rs == JNI_OK);
-    return env;
+    // Threads created natively, eg. workers firing callbacks, are
+    // attached on first use and detached when they exit
+    thread_local ThreadEnv s_threadEnv;
+    return s_threadEnv.Get(jvm);
 }
 
 JavaVM* GetJvm()
@@ -41,15 +313,133 @@ JavaVM* GetJvm()
     return s_jvm;
 }
 
+void RegisterDirectBuffer(JNIEnv* env, jobject buffer, void* data)
+{
+    env->CallStaticVoidMethod(s_binderUtilsClass, s_registerDirectBufferID, buffer, (jlong)data);
+}
+
+void GetBufferRange(JNIEnv* env, jobject buffer, jint& position, jint& limit)
+{
+    position = env->CallIntMethod(buffer, s_bufferPositionID);
+    limit = env->CallIntMethod(buffer, s_bufferLimitID);
+}
+
+bool RegisterClassNatives(JNIEnv* env, const char* className, const JNINativeMethod* methods, size_t count)
+{
+    if (count == 0)
+        return true;
+
+    jclass cls = env->FindClass(className);
+    if (cls == nullptr)
+    {
+        // The class may have been removed, eg. by a code shrinker
+        env->ExceptionClear();
+        return true;
+    }
+
+    bool ret = true;
+    if (env->RegisterNatives(cls, methods, (jint)count) != JNI_OK)
+    {
+#ifdef CB_JNI_HIDE_TRAMPOLINES
+        // The JVM can't fall back to resolve the exported symbols:
+        // keep the exception pending and fail the library loading
+        ret = false;
+#else
+        // The JVM falls back to resolve the exported symbols
+        env->ExceptionClear();
+#endif
+    }
+
+    env->DeleteLocalRef(cls);
+    return ret;
+}
+
 extern "C"
 {
+    // Hit and miss counters of the cache of returned strings for the
+    // given [CachedString] method, eg. "ENTextFieldGetText", or summed
+    // over all methods if null. Returns false if the method wasn't
+    // called yet
+    JNIEXPORT bool CB_JNIGetStringCacheStats(const char* method, uint64_t* hits, uint64_t* misses)
+    {
+        *hits = 0;
+        *misses = 0;
+        bool found = false;
+        std::lock_guard<std::mutex> lock(s_stringCacheStatsMutex);
+        for (auto stats = s_stringCacheStats; stats != nullptr; stats = stats->Next)
+        {
+            if (method != nullptr && std::strcmp(stats->Method, method) != 0)
+                continue;
+
+            *hits += stats->Hits.load(std::memory_order_relaxed);
+            *misses += stats->Misses.load(std::memory_order_relaxed);
+            found = true;
+        }
+
+        return found;
+    }
+
+    // The lookups below can't be skipped: on failure the pending
+    // exception, eg. NoClassDefFoundError when the class was removed by
+    // a code shrinker, is kept and the library loading fails. See the
+    // generated proguard-rules.pro for the members to keep
     JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* jvm, void* reserved)
     {
         s_jvm = jvm;
         auto env = getEnv(jvm);
+        if (env == nullptr)
+            return JNI_ERR;
+
         jclass cls = env->FindClass("CodeBinder/HandleRef");
+        if (cls == nullptr)
+            return JNI_ERR;
+
         handleFieldID = env->GetFieldID(cls, "handle", "J");
         env->DeleteLocalRef(cls);
+        if (handleFieldID == nullptr)
+            return JNI_ERR;
+
+        cls = env->FindClass("CodeBinder/BinderUtils");
+        if (cls == nullptr)
+            return JNI_ERR;
+
+        s_binderUtilsClass = (jclass)env->NewGlobalRef(cls);
+        s_registerDirectBufferID = env->GetStaticMethodID(cls, "registerDirectBuffer", "(Ljava/nio/ByteBuffer;J)V");
+        env->DeleteLocalRef(cls);
+        if (s_registerDirectBufferID == nullptr)
+            return JNI_ERR;
+
+        cls = env->FindClass("java/nio/Buffer");
+        if (cls == nullptr)
+            return JNI_ERR;
+
+        s_bufferPositionID = env->GetMethodID(cls, "position", "()I");
+        s_bufferLimitID = env->GetMethodID(cls, "limit", "()I");
+        env->DeleteLocalRef(cls);
+        if (s_bufferPositionID == nullptr || s_bufferLimitID == nullptr)
+            return JNI_ERR;
+
+        // Resolve box and optional field IDs once, so marshaling
+        // doesn't need reflective lookups on every call
+        _jBooleanBox::InitFieldId(env);
+        _jByteBox::InitFieldId(env);
+        _jShortBox::InitFieldId(env);
+        _jIntegerBox::InitFieldId(env);
+        _jLongBox::InitFieldId(env);
+        _jFloatBox::InitFieldId(env);
+        _jDoubleBox::InitFieldId(env);
+        _jStringBox::InitFieldId(env);
+        OPTJ2NImpl<cboptbool, jBoolean, cbbool>::InitFieldId(env);
+
+        if (!CB_JNIRegisterNatives(env))
+            return JNI_ERR;
+
         return JNI_VERSION;
     }
+
+    JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* jvm, void* reserved)
+    {
+        // Join the reclamation threads before the library is unloaded
+        cb::ShutdownReclaimer();
+    }
 }
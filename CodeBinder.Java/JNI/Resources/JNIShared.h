@@ -6,7 +6,34 @@
 #pragma once
 
 #include "JNITypesPrivate.h"
+#include <CBBaseTypes.h>
+#include <atomic>
+
+// Hit and miss counters of the cache of returned strings, declared
+// static by each [CachedString] trampoline. Constant initialized, so
+// it's registered on first use, see CB_JNIGetStringCacheStats()
+struct JStringCacheStats
+{
+    constexpr JStringCacheStats(const char* method)
+        : Method(method), Hits(0), Misses(0), Registered(false), Next(nullptr) { }
+
+    const char* Method;
+    std::atomic<uint64_t> Hits;
+    std::atomic<uint64_t> Misses;
+    std::atomic<bool> Registered;
+    JStringCacheStats* Next;
+};
 
 jlong GetHandle(JNIEnv* env, jHandleRef handleref);
+jstring CreateJString(JNIEnv* env, const cbstring& str);
+jstring GetCachedJString(JNIEnv* env, const cbstring& str, JStringCacheStats& stats);
+cbstring CreateCBString(JNIEnv* env, jstring str);
+// Attach the current thread if needed. Returns nullptr on failure
 JNIEnv* GetEnv();
 JavaVM* GetJvm();
+void RegisterDirectBuffer(JNIEnv* env, jobject buffer, void* data);
+void GetBufferRange(JNIEnv* env, jobject buffer, jint& position, jint& limit);
+bool RegisterClassNatives(JNIEnv* env, const char* className, const JNINativeMethod* methods, size_t count);
+
+// Generated in MethodInit.cpp
+bool CB_JNIRegisterNatives(JNIEnv* env);
@@ -5,6 +5,11 @@
 
 #include "JNITypesPrivate.h"
 
+const char* _jBooleanBoxBase::getClassName()
+{
+    return "CodeBinder/BooleanBox";
+}
+
 const char * _jBooleanBoxBase::getFieldIdSignature()
 {
     return "Z";
@@ -20,6 +25,11 @@ void _jBooleanBoxBase::setValue(JNIEnv * env, jfieldID field, ValueType value)
     env->SetBooleanField(this, field, value);
 }
 
+const char* _jByteBoxBase::getClassName()
+{
+    return "CodeBinder/ByteBox";
+}
+
 const char* _jByteBoxBase::getFieldIdSignature()
 {
     return "B";
@@ -35,6 +45,11 @@ void _jByteBoxBase::setValue(JNIEnv * env, jfieldID field, ValueType value)
     env->SetByteField(this, field, value);
 }
 
+const char* _jShortBoxBase::getClassName()
+{
+    return "CodeBinder/ShortBox";
+}
+
 const char * _jShortBoxBase::getFieldIdSignature()
 {
     return "S";
@@ -50,6 +65,11 @@ void _jShortBoxBase::setValue(JNIEnv * env, jfieldID field, ValueType value)
     env->SetShortField(this, field, value);
 }
 
+const char* _jIntegerBoxBase::getClassName()
+{
+    return "CodeBinder/IntegerBox";
+}
+
 const char * _jIntegerBoxBase::getFieldIdSignature()
 {
     return "I";
@@ -65,6 +85,11 @@ void _jIntegerBoxBase::setValue(JNIEnv * env, jfieldID field, ValueType value)
     env->SetIntField(this, field, value);
 }
 
+const char* _jLongBoxBase::getClassName()
+{
+    return "CodeBinder/LongBox";
+}
+
 const char * _jLongBoxBase::getFieldIdSignature()
 {
     return "J";
@@ -80,6 +105,11 @@ void _jLongBoxBase::setValue(JNIEnv * env, jfieldID field, ValueType value)
     env->SetLongField(this, field, value);
 }
 
+const char* _jFloatBoxBase::getClassName()
+{
+    return "CodeBinder/FloatBox";
+}
+
 const char * _jFloatBoxBase::getFieldIdSignature()
 {
     return "F";
@@ -95,6 +125,11 @@ void _jFloatBoxBase::setValue(JNIEnv * env, jfieldID field, ValueType value)
     env->SetFloatField(this, field, value);
 }
 
+const char* _jDoubleBoxBase::getClassName()
+{
+    return "CodeBinder/DoubleBox";
+}
+
 const char * _jDoubleBoxBase::getFieldIdSignature()
 {
     return "D";
@@ -110,6 +145,11 @@ void _jDoubleBoxBase::setValue(JNIEnv * env, jfieldID field, ValueType value)
     env->SetDoubleField(this, field, value);
 }
 
+const char* _jStringBoxBase::getClassName()
+{
+    return "CodeBinder/StringBox";
+}
+
 const char * _jStringBoxBase::getFieldIdSignature()
 {
     return "Ljava/lang/String;";
@@ -18,6 +18,17 @@
 #define JNIEXPORT __attribute__((visibility("default")))
 #endif
 
+// Trampolines with a known signature are bound with RegisterNatives
+// in JNI_OnLoad, so they don't need to be looked up by symbol name.
+// Define CB_JNI_HIDE_TRAMPOLINES to drop them from the dynamic symbols
+#if defined(CB_JNI_HIDE_TRAMPOLINES) && (defined(__GNUC__) || defined(__clang__))
+#define CB_JNI_TRAMPOLINE __attribute__((visibility("hidden")))
+#elif defined(CB_JNI_HIDE_TRAMPOLINES)
+#define CB_JNI_TRAMPOLINE
+#else
+#define CB_JNI_TRAMPOLINE JNIEXPORT
+#endif
+
 #define jBooleanBox jobject
 #define jByteBox jobject
 #define jShortBox jobject
@@ -29,6 +40,7 @@
 #define jHandleRef jobject
 
 typedef jobject jBoolean;
+typedef jobject jByteBuffer;
 
 // Support class for array of pointers
 class _jptrArray : public _jlongArray {};
@@ -28,8 +28,12 @@ class _jTypeBox : public BaseT
 public:
     typename BaseT::ValueType GetValue(JNIEnv* env) const;
     void SetValue(JNIEnv* env, typename BaseT::ValueType value);
+    static void InitFieldId(JNIEnv* env);
 private:
     jfieldID getFieldId(JNIEnv* env) const;
+private:
+    // Resolved once in JNI_OnLoad
+    static inline jfieldID s_fieldId;
 };
 
 // Base box types
@@ -62,6 +66,7 @@ public:
     typedef jBooleanBox BoxPtr;
     typedef jboolean ValueType;
 protected:
+    static const char* getClassName();
     static const char* getFieldIdSignature();
     ValueType getValue(JNIEnv* env, jfieldID field) const;
     void setValue(JNIEnv* env, jfieldID field, ValueType value);
@@ -73,6 +78,7 @@ public:
     typedef jByteBox BoxPtr;
     typedef jbyte ValueType;
 protected:
+    static const char* getClassName();
     static const char* getFieldIdSignature();
     ValueType getValue(JNIEnv* env, jfieldID field) const;
     void setValue(JNIEnv* env, jfieldID field, ValueType value);
@@ -84,6 +90,7 @@ public:
     typedef jShortBox BoxPtr;
     typedef jshort ValueType;
 protected:
+    static const char* getClassName();
     static const char* getFieldIdSignature();
     ValueType getValue(JNIEnv* env, jfieldID field) const;
     void setValue(JNIEnv* env, jfieldID field, ValueType value);
@@ -95,6 +102,7 @@ public:
     typedef jIntegerBox BoxPtr;
     typedef jint ValueType;
 protected:
+    static const char* getClassName();
     static const char* getFieldIdSignature();
     ValueType getValue(JNIEnv* env, jfieldID field) const;
     void setValue(JNIEnv* env, jfieldID field, ValueType value);
@@ -106,6 +114,7 @@ public:
     typedef jLongBox BoxPtr;
     typedef jlong ValueType;
 protected:
+    static const char* getClassName();
     static const char* getFieldIdSignature();
     ValueType getValue(JNIEnv* env, jfieldID field) const;
     void setValue(JNIEnv* env, jfieldID field, ValueType value);
@@ -117,6 +126,7 @@ public:
     typedef jFloatBox BoxPtr;
     typedef jfloat ValueType;
 protected:
+    static const char* getClassName();
     static const char* getFieldIdSignature();
     ValueType getValue(JNIEnv* env, jfieldID field) const;
     void setValue(JNIEnv* env, jfieldID field, ValueType value);
@@ -128,6 +138,7 @@ public:
     typedef jDoubleBox BoxPtr;
     typedef jdouble ValueType;
 protected:
+    static const char* getClassName();
     static const char* getFieldIdSignature();
     ValueType getValue(JNIEnv* env, jfieldID field) const;
     void setValue(JNIEnv* env, jfieldID field, ValueType  value);
@@ -139,6 +150,7 @@ public:
     typedef jStringBox BoxPtr;
     typedef jstring ValueType;
 protected:
+    static const char* getClassName();
     static const char* getFieldIdSignature();
     ValueType getValue(JNIEnv* env, jfieldID field) const;
     void setValue(JNIEnv* env, jfieldID field, ValueType  value);
@@ -166,11 +178,32 @@ void _jTypeBox<BaseT>::SetValue(JNIEnv* env, typename BaseT::ValueType value)
     this->setValue(env, getFieldId(env), value);
 }
 
+template<typename BaseT>
+void _jTypeBox<BaseT>::InitFieldId(JNIEnv* env)
+{
+    jclass cls = env->FindClass(BaseT::getClassName());
+    if (cls == nullptr)
+    {
+        // The class may have been stripped, eg. by a shrinker. Lookups
+        // will be done on the object class instead
+        env->ExceptionClear();
+        return;
+    }
+
+    s_fieldId = env->GetFieldID(cls, "value", BaseT::getFieldIdSignature());
+    env->DeleteLocalRef(cls);
+}
+
 template<typename BaseT>
 jfieldID _jTypeBox<BaseT>::getFieldId(JNIEnv* env) const
 {
+    if (s_fieldId != nullptr)
+        return s_fieldId;
+
     auto cls = env->GetObjectClass((jobject)this);
-    return env->GetFieldID(cls, "value", this->getFieldIdSignature());
+    auto ret = env->GetFieldID(cls, "value", this->getFieldIdSignature());
+    env->DeleteLocalRef(cls);
+    return ret;
 }
 
 class _jHandleRef : public _jobject
@@ -1,5 +1,6 @@
 ﻿// SPDX-FileCopyrightText: (C) 2020 Francesco Pretto <ceztko@gmail.com>
 // SPDX-License-Identifier: MIT
+using CodeBinder.Attributes;
 using System.Linq;
 
 namespace CodeBinder.Java;
@@ -67,6 +68,8 @@ static partial class JavaExtensions
         }
 
         yield return new MethodWriter(method, -1, context);
+        if (method.IsNative(context) && method.HasAttribute<BatchedReleaseAttribute>(context))
+            yield return new BatchedReleaseMethodWriter(method);
     }
 
     static IEnumerable<CodeWriter> getConstructorWriters(ConstructorDeclarationSyntax method, JavaCodeConversionContext context)
@@ -121,12 +124,57 @@ protected HandledObjectFinalizer createFinalizer()
             Builder.AppendLine($"static class {_finalizableType.Name}Finalizer extends HandledObjectFinalizer");
             using (Builder.Block())
             {
-                Builder.AppendLine("public void freeHandle(long handle)");
-                using (Builder.Block())
+                if (_block.TryGetBatchedReleaseMethod(_context, out var release))
                 {
-                    Builder.Append(_block, _context, true).AppendLine();
+                    // Handles are released in bulk through the batched entry point
+                    string releaseMethod = $"{release.Name}Batch";
+                    if (!SymbolEqualityComparer.Default.Equals(release.ContainingType, _finalizableType))
+                        releaseMethod = $"{release.ContainingType.Name}.{releaseMethod}";
+
+                    Builder.AppendLine($$"""
+static final HandleReleaseQueue _releaseQueue = new HandleReleaseQueue(new HandleReleaseQueue.Releaser() {
+    public void release(long[] handles, int count)
+    {
+        {{releaseMethod}}(handles, count);
+    }
+});
+""");
+                    Builder.AppendLine();
+                    Builder.AppendLine("public void freeHandle(long handle)");
+                    using (Builder.Block())
+                    {
+                        Builder.AppendLine("_releaseQueue.enqueue(handle);");
+                    }
+                }
+                else
+                {
+                    Builder.AppendLine("public void freeHandle(long handle)");
+                    using (Builder.Block())
+                    {
+                        Builder.Append(_block, _context, true).AppendLine();
+                    }
                 }
             }
         }
     }
+
+    class BatchedReleaseMethodWriter : CodeWriter
+    {
+        MethodDeclarationSyntax _method;
+
+        public BatchedReleaseMethodWriter(MethodDeclarationSyntax method)
+        {
+            _method = method;
+        }
+
+        protected override void Write()
+        {
+            // e.g. static native void SLFreeDocumentBatch(long[] handles, int count);
+            string modifiers = _method.GetJavaModifiersString();
+            if (!modifiers.IsNullOrEmpty())
+                Builder.Append(modifiers).Space();
+
+            Builder.Append($"void {_method.GetName()}Batch(long[] handles, int count)").EndOfStatement();
+        }
+    }
 }
@@ -513,6 +513,13 @@ static partial class JavaExtensions
                 }
                 case SyntaxKind.NullableType:
                 {
+                    if (symbol.Kind == SymbolKind.ArrayType)
+                    {
+                        // Nullable reference array, e.g. string[]?
+                        builder.Append(((NullableTypeSyntax)type).ElementType, context);
+                        break;
+                    }
+
                     string? boxTypeName;
                     if (JavaUtils.TryGetBoxType(fullTypeName, out boxTypeName))
                         builder.Append(boxTypeName);
@@ -792,6 +799,15 @@ static partial class JavaExtensions
                 case "System.String":
                     knownJavaType = "String";
                     return true;
+                case "CodeBinder.cbbuffer":
+                    knownJavaType = "byte[]";
+                    return true;
+                case "CodeBinder.cbstringarray":
+                    knownJavaType = "String[]";
+                    return true;
+                case "CodeBinder.cbspan":
+                    knownJavaType = "java.nio.ByteBuffer";
+                    return true;
                 // Boxed types
                 case "System.IntPtr":
                     knownJavaType = "Long";
@@ -853,6 +869,15 @@ static partial class JavaExtensions
                 case "System.String":
                     knownJavaType = "String";
                     return true;
+                case "CodeBinder.cbbuffer":
+                    knownJavaType = "byte[]";
+                    return true;
+                case "CodeBinder.cbstringarray":
+                    knownJavaType = "String[]";
+                    return true;
+                case "CodeBinder.cbspan":
+                    knownJavaType = "java.nio.ByteBuffer";
+                    return true;
                 case "System.IntPtr":
                     knownJavaType = "long";
                     return true;
@@ -7,6 +7,12 @@ static class JavaClasses
 {
     public const string BinderUtils =
 @"import java.lang.reflect.*;
+import java.lang.ref.PhantomReference;
+import java.lang.ref.ReferenceQueue;
+import java.nio.ByteBuffer;
+import java.util.Collections;
+import java.util.HashSet;
+import java.util.Set;
 
 public class BinderUtils
 {
@@ -14,6 +20,9 @@ public class BinderUtils
     static Object _cleaner;
     static Method _register;
     static final ThreadLocal<RuntimeException> _exception = new ThreadLocal<RuntimeException>();
+    static final ReferenceQueue<ByteBuffer> _bufferQueue = new ReferenceQueue<ByteBuffer>();
+    static final Set<DirectBufferReference> _bufferReferences = Collections.synchronizedSet(new HashSet<DirectBufferReference>());
+    static volatile Thread _bufferReleaser;
 
     static
     {
@@ -33,7 +42,7 @@ public class BinderUtils
             }
             catch (ClassNotFoundException ex)
             {
-                // Do nothing. ""java.lang.ref.Cleaner"" is not avaiable
+                // Do nothing. ""java.lang.ref.Cleaner"" is not available
             }
             catch (InvocationTargetException | IllegalAccessException |
                    NoSuchMethodException ex)
@@ -83,7 +92,7 @@ public class BinderUtils
         }
     }
 
-    public static boolean isCleanerAvaiable()
+    public static boolean isCleanerAvailable()
     {
         return _cleaner != null;
     }
@@ -124,13 +133,106 @@ public class BinderUtils
         }
     }
 
+    // Release the native memory of a direct buffer when it's collected
+    static void registerDirectBuffer(ByteBuffer buffer, long address)
+    {
+        if (_cleaner != null)
+        {
+            registerForFinalization(buffer, new DirectBufferFinalizer(address));
+            return;
+        }
+
+        // Cleaner is not available: track the buffer with a phantom
+        // reference, collected buffers are released by a daemon thread
+        if (_bufferReleaser == null)
+            startBufferReleaser();
+
+        _bufferReferences.add(new DirectBufferReference(buffer, address, _bufferQueue));
+    }
+
+    static synchronized void startBufferReleaser()
+    {
+        if (_bufferReleaser != null)
+            return;
+
+        Thread thread = new Thread(new Runnable()
+        {
+            public void run()
+            {
+                while (true)
+                {
+                    DirectBufferReference reference;
+                    try
+                    {
+                        reference = (DirectBufferReference)_bufferQueue.remove();
+                    }
+                    catch (InterruptedException ex)
+                    {
+                        return;
+                    }
+
+                    _bufferReferences.remove(reference);
+                    freeMemory(reference.address);
+                }
+            }
+        }, ""CodeBinder buffer releaser"");
+        thread.setDaemon(true);
+        thread.start();
+        _bufferReleaser = thread;
+    }
+
+    static class DirectBufferFinalizer implements IObjectFinalizer
+    {
+        final long address;
+
+        DirectBufferFinalizer(long address)
+        {
+            this.address = address;
+        }
+
+        public void run()
+        {
+            freeMemory(address);
+        }
+    }
+
+    static class DirectBufferReference extends PhantomReference<ByteBuffer>
+    {
+        final long address;
+
+        DirectBufferReference(ByteBuffer buffer, long address, ReferenceQueue<ByteBuffer> queue)
+        {
+            super(buffer, queue);
+            this.address = address;
+        }
+    }
+
     static native long newGlobalRef(Object obj);
     static native void deleteGlobalRef(long globalref);
     static native long newGlobalWeakRef(Object obj);
     static native void deleteGlobalWeakRef(long globalref);
     static native Object getGlobalRefTarget(long handle);
     static native Object getGlobalWeakRefTarget(long handle);
+    static native void freeMemory(long address);
+    static native void setFinalizerThread();
 }";
+    // Keep rules for ProGuard/R8: members looked up by name in JNI_OnLoad
+    public const string ProguardRules =
+@"# Members looked up by name from the JNI glue, see JNI_OnLoad
+-keep class CodeBinder.BinderUtils {
+    static void registerDirectBuffer(java.nio.ByteBuffer, long);
+}
+-keepclassmembers class CodeBinder.HandleRef {
+    long handle;
+}
+-keepclassmembers class CodeBinder.*Box {
+    <fields>;
+}
+-keepclasseswithmembernames,includedescriptorclasses class * {
+    native <methods>;
+}
+";
+
     // https://docs.microsoft.com/en-us/dotnet/api/system.runtime.interopservices.handleref
     public const string HandleRef =
 @"// https://docs.microsoft.com/en-us/dotnet/api/system.runtime.interopservices.handleref
@@ -201,7 +303,7 @@ public abstract class FinalizableObject
 
     protected void registerFinalizer(IObjectFinalizer finalizer)
     {
-        if (BinderUtils.isCleanerAvaiable())
+        if (BinderUtils.isCleanerAvailable())
         {
             BinderUtils.registerForFinalization(this, finalizer);
         }
@@ -222,10 +324,12 @@ public abstract class FinalizableObject
 public class HandledObjectBase extends FinalizableObject
 {
     long _handle;
+    boolean _handled;
 
     protected HandledObjectBase(long handle, boolean handled)
     {
         _handle = handle;
+        _handled = handled;
         if (handled)
         {
             HandledObjectFinalizer finalizer = createFinalizer();
@@ -305,17 +409,257 @@ public abstract class HandledObjectFinalizer implements IObjectFinalizer
     // For retrocompatibility
     protected void finalize() throws Throwable
     {
-        if (!BinderUtils.isCleanerAvaiable())
+        if (!BinderUtils.isCleanerAvailable())
+        {
+            BinderUtils.setFinalizerThread();
             freeHandle(handle);
+        }
     }
 
+    // Run by the Cleaner thread, which must never stall
     public void run()
     {
+        BinderUtils.setFinalizerThread();
         freeHandle(handle);
     }
 
     public abstract void freeHandle(long handle);
 }
+""";
+
+    public const string HandleReleaseQueue = """
+import java.util.Timer;
+import java.util.TimerTask;
+
+// Accumulates the handles of collected objects and releases them in bulk
+// with a single native call. The queue is flushed when it reaches the
+// threshold or when the interval elapsed since the first pending handle
+public final class HandleReleaseQueue
+{
+    public static final int DEFAULT_THRESHOLD = 256;
+    public static final long DEFAULT_INTERVAL = 1000;
+
+    static Timer _timer;
+
+    final Releaser _releaser;
+    final int _threshold;
+    final long _interval;
+    long[] _handles;
+    int _count;
+    boolean _scheduled;
+    long _flushCount;
+    long _lastFlushLatency;
+    long _totalFlushLatency;
+
+    public interface Releaser
+    {
+        void release(long[] handles, int count);
+    }
+
+    public HandleReleaseQueue(Releaser releaser)
+    {
+        this(releaser, DEFAULT_THRESHOLD, DEFAULT_INTERVAL);
+    }
+
+    // The interval is expressed in milliseconds
+    public HandleReleaseQueue(Releaser releaser, int threshold, long interval)
+    {
+        if (threshold < 1)
+            throw new IllegalArgumentException("The threshold must be positive");
+
+        _releaser = releaser;
+        _threshold = threshold;
+        _interval = interval;
+        _handles = new long[threshold];
+    }
+
+    public void enqueue(long handle)
+    {
+        long[] handles;
+        synchronized (this)
+        {
+            _handles[_count] = handle;
+            _count++;
+            if (_count < _threshold)
+            {
+                if (!_scheduled)
+                {
+                    _scheduled = true;
+                    getTimer().schedule(new FlushTask(this), _interval);
+                }
+
+                return;
+            }
+
+            handles = _handles;
+            _handles = new long[_threshold];
+            _count = 0;
+        }
+
+        // Release outside the lock, so finalizers don't wait for the native call
+        release(handles, _threshold);
+    }
+
+    public void flush()
+    {
+        long[] handles;
+        int count;
+        synchronized (this)
+        {
+            _scheduled = false;
+            if (_count == 0)
+                return;
+
+            handles = _handles;
+            count = _count;
+            _handles = new long[_threshold];
+            _count = 0;
+        }
+
+        release(handles, count);
+    }
+
+    // Number of handles waiting to be released
+    public synchronized int getDepth()
+    {
+        return _count;
+    }
+
+    public synchronized long getFlushCount()
+    {
+        return _flushCount;
+    }
+
+    // Duration of the last flush, in nanoseconds
+    public synchronized long getLastFlushLatency()
+    {
+        return _lastFlushLatency;
+    }
+
+    // Overall time spent flushing, in nanoseconds
+    public synchronized long getTotalFlushLatency()
+    {
+        return _totalFlushLatency;
+    }
+
+    void release(long[] handles, int count)
+    {
+        long start = System.nanoTime();
+        _releaser.release(handles, count);
+        long latency = System.nanoTime() - start;
+        synchronized (this)
+        {
+            _flushCount++;
+            _lastFlushLatency = latency;
+            _totalFlushLatency += latency;
+        }
+    }
+
+    static synchronized Timer getTimer()
+    {
+        if (_timer == null)
+            _timer = new Timer("HandleReleaseQueue", true);
+
+        return _timer;
+    }
+
+    static class FlushTask extends TimerTask
+    {
+        final HandleReleaseQueue _queue;
+
+        FlushTask(HandleReleaseQueue queue)
+        {
+            _queue = queue;
+        }
+
+        public void run()
+        {
+            // An exception would cancel the timer shared by all the queues
+            try
+            {
+                _queue.flush();
+            }
+            catch (Throwable ex)
+            {
+                System.err.println(ex);
+            }
+        }
+    }
+}
+""";
+
+    public const string HandledObjectCache = """
+import java.lang.ref.ReferenceQueue;
+import java.lang.ref.WeakReference;
+import java.util.HashMap;
+
+// Optional weak identity map of wrappers, keyed by native handle. Looking up
+// an handle that is still wrapped by a live object returns the same wrapper,
+// instead of allocating a new one. Entries don't keep wrappers alive.
+// Only wrappers of handles owned elsewhere (eg. by a parent object) can be
+// cached: the owner must remove() the handle when it releases the native
+// object, since the address can be reused by a new one
+public final class HandledObjectCache<T extends HandledObjectBase>
+{
+    final HashMap<Long, Entry<T>> _map;
+    final ReferenceQueue<T> _queue;
+
+    public HandledObjectCache()
+    {
+        _map = new HashMap<Long, Entry<T>>();
+        _queue = new ReferenceQueue<T>();
+    }
+
+    // Get the live wrapper of the handle, or null if there's none
+    public synchronized T get(long handle)
+    {
+        purge();
+        Entry<T> entry = _map.get(handle);
+        if (entry == null)
+            return null;
+
+        return entry.get();
+    }
+
+    public synchronized void add(T obj)
+    {
+        if (obj._handled)
+            throw new IllegalArgumentException("Wrappers of owned handles can't be cached");
+
+        purge();
+        long handle = obj.getUnsafeHandle();
+        _map.put(handle, new Entry<T>(handle, obj, _queue));
+    }
+
+    // Forget the wrapper of the handle, eg. when the handle is released explicitly
+    public synchronized void remove(long handle)
+    {
+        _map.remove(handle);
+    }
+
+    @SuppressWarnings("unchecked")
+    void purge()
+    {
+        Entry<T> entry;
+        while ((entry = (Entry<T>)_queue.poll()) != null)
+        {
+            // The handle may have been wrapped again in the meantime
+            if (_map.get(entry.handle) == entry)
+                _map.remove(entry.handle);
+        }
+    }
+
+    static final class Entry<T> extends WeakReference<T>
+    {
+        final long handle;
+
+        Entry(long handle, T obj, ReferenceQueue<T> queue)
+        {
+            super(obj, queue);
+            this.handle = handle;
+        }
+    }
+}
 """;
 
     //// TODO: alternatively inherits Runnable or not
@@ -1,6 +1,7 @@
 ﻿// SPDX-FileCopyrightText: (C) 2023 Francesco Pretto <ceztko@gmail.com>
 // SPDX-License-Identifier: MIT
 
+using CodeBinder.Attributes;
 using CodeBinder.JavaScript.NAPI;
 
 namespace CodeBinder.JavaScript;
@@ -19,6 +20,8 @@ public class ConversionCSharpToNAPI : CSharpLanguageConversionBase<NAPICompilati
 
     public override MethodCasing MethodCasing => MethodCasing.LowerCamelCase;
 
+    public override IReadOnlyCollection<string> SupportedPolicies => new[] { Features.Delegates };
+
     public override IReadOnlyList<string> PreprocessorDefinitions
     {
         get { return new string[] { "NODEJS", "NAPI" }; }
@@ -48,12 +51,16 @@ public class ConversionCSharpToNAPI : CSharpLanguageConversionBase<NAPICompilati
 NAPI {
     global: _init; _fini;
         napi_register_module_v1;
+        CB_NAPIGetTrampolineStats;
+        CB_NAPIGetReclaimerStats;
     local: *;
 };
 """;
 
     const string Exports_ld64 = """
 _napi_register_module_v1
+_CB_NAPIGetTrampolineStats
+_CB_NAPIGetReclaimerStats
 
 """;
 }
@@ -40,7 +40,7 @@ public class ConversionCSharpToTypeScript : CSharpLanguageConversion<TypeScriptC
         return new TypeScriptValidationContext(this);
     }
 
-    public override IReadOnlyCollection<string> SupportedPolicies => new string[] { Features.GarbageCollection, Features.Iterators, Features.Generators };
+    public override IReadOnlyCollection<string> SupportedPolicies => new string[] { Features.GarbageCollection, Features.Iterators, Features.Generators, Features.Delegates };
 
     public override IReadOnlyList<string> PreprocessorDefinitions
     {
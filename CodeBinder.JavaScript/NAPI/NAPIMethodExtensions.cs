@@ -10,6 +10,22 @@ static class NAPIMethodExtensions
         return $"NAPI_{method.GetName()}";
     }
 
+    /// <summary>
+    /// Name of the bulk entry point of a [BatchedRelease] method
+    /// </summary>
+    public static string GetNAPIBatchedReleaseMethodName(this MethodDeclarationSyntax method)
+    {
+        return $"NAPI_{method.GetName()}Batch";
+    }
+
+    /// <summary>
+    /// Name of the Promise returning entry point of an [Async] method
+    /// </summary>
+    public static string GetNAPIAsyncMethodName(this MethodDeclarationSyntax method)
+    {
+        return $"NAPI_{method.GetName()}Async";
+    }
+
     public static string GetNAPIType(this ParameterSyntax parameter, ICompilationProvider provider)
     {
         var symbol = parameter.Type!.GetTypeSymbolThrow(provider);
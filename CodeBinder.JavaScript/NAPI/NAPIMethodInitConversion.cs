@@ -41,16 +41,14 @@ builder.AppendLine();
         builder.AppendLine("namespace js");
         using (builder.Block())
         {
-            builder.Append("napi_ref s_AddonThisRef").EndOfStatement();
-            builder.Append("napi_env s_Env").EndOfStatement();
-            builder.AppendLine();
             builder.AppendLine("""
 extern "C" void Destructor(napi_env env, void* finalize_data, void* finalize_hint)
 {
     (void)finalize_data;
     (void)finalize_hint;
-    (void)napi_delete_reference(env, s_AddonThisRef);
-    s_AddonThisRef = nullptr;
+    auto& state = GetEnvState(env);
+    (void)napi_delete_reference(env, state.AddonThisRef);
+    state.AddonThisRef = nullptr;
 }
 """);
             builder.AppendLine();
@@ -60,7 +58,10 @@ extern "C" void Destructor(napi_env env, void* finalize_data, void* finalize_hin
                 builder.AppendLine("""
 napi_status status;
 
-if (s_AddonThisRef != nullptr)
+// The state is per env, so the addon can be initialized once in
+// the main thread and once in every worker thread
+auto& state = GetEnvState(env);
+if (state.AddonThisRef != nullptr)
 {
     napi_throw_error(env, nullptr, "The addon was already initalized");
     return nullptr;
@@ -71,7 +72,7 @@ napi_value args[1];
 status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
 assert(status == napi_ok);
 
-status = napi_create_reference(env, args[0], 1, &s_AddonThisRef);
+status = napi_create_reference(env, args[0], 1, &state.AddonThisRef);
 assert(status == napi_ok);
 
 napi_value obj;
@@ -97,6 +98,10 @@ assert(status == napi_ok);
                                 builder.Append("#ifdef").Space().Append(condition).AppendLine();
                             }
                             declareMethod(builder, method.GetName(), method.GetNAPIMethodName());
+                            if (method.HasAttribute<BatchedReleaseAttribute>(_compilation))
+                                declareMethod(builder, $"{method.GetName()}Batch", method.GetNAPIBatchedReleaseMethodName());
+                            if (method.HasAttribute<AsyncAttribute>(_compilation))
+                                declareMethod(builder, $"{method.GetName()}Async", method.GetNAPIAsyncMethodName());
                             if (condition != null)
                                 builder.Append("#endif //").Space().Append(condition).AppendLine();
                         }
@@ -106,12 +111,12 @@ assert(status == napi_ok);
                     declareMethod(builder, "CreateWeakNativeHandle", "NAPI_CreateWeakNativeHandle");
                     declareMethod(builder, "FreeNativeHandle", "NAPI_FreeNativeHandle");
                     declareMethod(builder, "NativeHandleGetTarget", "NAPI_NativeHandleGetTarget");
+                    declareMethod(builder, "WrapHandleRef", "NAPI_WrapHandleRef");
                 }
                 builder.EndOfStatement();
                 builder.AppendLine();
                 builder.Append("status = napi_define_properties(env, obj, std::size(addDescriptor), addDescriptor)").EndOfStatement();
                 builder.Append("assert(status == napi_ok)").EndOfStatement();
-                builder.Append("s_Env = env").EndOfStatement();
                 builder.Append("return obj").EndOfStatement();
             }
 
@@ -120,8 +125,15 @@ assert(status == napi_ok);
 $$"""
 extern "C" napi_value Init(napi_env env, napi_value exports)
 {
+    napi_status status = CreateEnvState(env);
+    if (status != napi_ok)
+    {
+        napi_throw_error(env, nullptr, "Could not create the addon environment state");
+        return nullptr;
+    }
+
     napi_value new_exports;
-    napi_status status = napi_create_function(
+    status = napi_create_function(
         env, "", NAPI_AUTO_LENGTH, CreateAddon, nullptr, &new_exports);
     assert(status == napi_ok);
     return new_exports;
@@ -132,6 +144,19 @@ extern "C" EXPORT_ATTRIB napi_value napi_register_module_v1(napi_env env, napi_v
     return Init(env, exports);
 }
 
+// Snapshot of the trampoline call statistics, see CBTrampolineStats.hpp.
+// No trampoline is listed unless compiled with CB_TRAMPOLINE_STATS
+extern "C" EXPORT_ATTRIB size_t CB_NAPIGetTrampolineStats(CBTrampolineStats* stats, size_t count)
+{
+    return cb::GetTrampolineStats(stats, count);
+}
+
+// Snapshot of the background reclamation queue, see CBReclaimer.hpp
+extern "C" EXPORT_ATTRIB void CB_NAPIGetReclaimerStats(CBReclaimerStats* stats)
+{
+    cb::GetReclaimerStats(*stats);
+}
+
 // Reference this symbol to ensure all functions are defined"
 // See https://github.com/dotnet/samples/tree/3870722f5c5e80fd6a70946e6e96a5c990620e42/core/nativeaot/NativeLibrary#user-content-building-static-libraries
 extern "C"
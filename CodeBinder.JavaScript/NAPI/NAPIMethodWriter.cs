@@ -1,6 +1,8 @@
 ﻿// SPDX-FileCopyrightText: (C) 2023 Francesco Pretto <ceztko@gmail.com>
 // SPDX-License-Identifier: MIT
 
+using System.Linq;
+
 namespace CodeBinder.JavaScript.NAPI;
 
 class NAPITrampolineMethodWriter : CodeWriter<MethodDeclarationSyntax, NAPIModuleConversion>
@@ -42,9 +44,21 @@ class NAPITrampolineMethodWriter : CodeWriter<MethodDeclarationSyntax, NAPIModul
         Builder.Append("(void)napistatus_").EndOfStatement();
         Builder.AppendLine();
 
-        bindParameters();
+        // Call instrumentation, compiled only with CB_TRAMPOLINE_STATS
+        Builder.Append($"CB_TRAMPOLINE_PROBE(\"{Item.GetCLangMethodName()}\")").EndOfStatement();
+        Builder.AppendLine();
 
         var methodSymbol = Item.GetDeclaredSymbol<IMethodSymbol>(Context);
+        if (needScratchScope(methodSymbol))
+        {
+            // Transient strings are allocated in the scratch arena,
+            // which is recycled when the scope exits
+            Builder.Append("cb::ScratchScope scratch_").EndOfStatement();
+            Builder.AppendLine();
+        }
+
+        bindParameters();
+
         if (!methodSymbol.ReturnsVoid)
         {
             Builder.Append(methodSymbol.GetCLangReturnType()).Space().Append("cret_").Space().Append("=").Space();
@@ -187,12 +201,20 @@ class NAPITrampolineMethodWriter : CodeWriter<MethodDeclarationSyntax, NAPIModul
                         case "System.Int64":
                         case "System.Single":
                         case "System.Double":
-                        case "CodeBinder.cbstring":
                         case "CodeBinder.cbbool":
                         {
                             Builder.Append("CreateNapiValue(env, cret_)").EndOfStatement();
                             break;
                         }
+                        case "CodeBinder.cbstring":
+                        case "CodeBinder.cbbuffer":
+                        case "CodeBinder.cbstringarray":
+                        case "CodeBinder.cbspan":
+                        {
+                            // Move the value so it's released after the conversion
+                            Builder.Append("CreateNapiValue(env, std::move(cret_))").EndOfStatement();
+                            break;
+                        }
                         default:
                         {
                             throw new NotSupportedException();
@@ -204,6 +226,23 @@ class NAPITrampolineMethodWriter : CodeWriter<MethodDeclarationSyntax, NAPIModul
         }
     }
 
+    // Converted string parameters are allocated in the arena, as well as
+    // returned strings built with cb::ScratchString, which are converted
+    // before the scope exits
+    static bool needScratchScope(IMethodSymbol method)
+    {
+        if (method.ReturnType.GetFullName() == "CodeBinder.cbstring")
+            return true;
+
+        foreach (var param in method.Parameters)
+        {
+            if (param.Type.GetFullName() == "CodeBinder.cbstring")
+                return true;
+        }
+
+        return false;
+    }
+
     void bindParameters()
     {
         int parameterCount = Item.ParameterList.Parameters.Count;
@@ -216,8 +255,45 @@ class NAPITrampolineMethodWriter : CodeWriter<MethodDeclarationSyntax, NAPIModul
         Builder.AppendLine($"assert(argc == {parameterCount});");
 
         Builder.AppendLine();
+        bool canThrow = false;
         for (int i = 0; i < Item.ParameterList.Parameters.Count; i++)
-            bindParameter(Item.ParameterList.Parameters[i], i);
+        {
+            var param = Item.ParameterList.Parameters[i];
+            bindParameter(param, i);
+            canThrow |= canParameterThrow(param.GetDeclaredSymbol<IParameterSymbol>(Context));
+        }
+
+        if (canThrow)
+        {
+            // Don't call the native function with arguments that failed to convert
+            Builder.AppendLine();
+            Builder.Append("if (IsJSExceptionPending(env))").AppendLine();
+            Builder.IndentChild().Append("return nullptr").EndOfStatement().Close();
+            Builder.AppendLine();
+        }
+    }
+
+    // Conversions that throw a JS exception on invalid arguments
+    protected static bool canParameterThrow(IParameterSymbol symbol)
+    {
+        if (symbol.IsRefLike())
+            return false;
+
+        return symbol.Type.TypeKind == TypeKind.Delegate
+            || symbol.Type.GetFullName() == "CodeBinder.cbspan";
+    }
+
+    int getCallbackOwnerIndex()
+    {
+        var parameters = Item.ParameterList.Parameters;
+        for (int i = 0; i < parameters.Count; i++)
+        {
+            var symbol = parameters[i].GetDeclaredSymbol<IParameterSymbol>(Context);
+            if (!symbol.IsRefLike() && symbol.Type.GetFullName() == "System.Runtime.InteropServices.HandleRef")
+                return i;
+        }
+
+        return -1;
     }
 
     void writeBoxParameter(ParameterSyntax param, IParameterSymbol symbol)
@@ -228,7 +304,7 @@ class NAPITrampolineMethodWriter : CodeWriter<MethodDeclarationSyntax, NAPIModul
             .Parenthesized().Append("env").CommaSeparator().Append(param.Identifier.Text).Close();
     }
 
-    void bindParameter(ParameterSyntax param, int index)
+    protected void bindParameter(ParameterSyntax param, int index)
     {
         Builder.Append("auto").Space().Append(param.Identifier.Text).Space().Append("=").Space();
         var symbol = param.GetDeclaredSymbol<IParameterSymbol>(Context);
@@ -259,6 +335,29 @@ class NAPITrampolineMethodWriter : CodeWriter<MethodDeclarationSyntax, NAPIModul
 
                 break;
             }
+            case TypeKind.Delegate:
+            {
+                if (symbol.IsRefLike())
+                    throw new NotSupportedException("ref like delegate parameter is unsupported");
+
+                // Invocations are delivered to JS asynchronously, so they can't return a value
+                var invokeMethod = ((INamedTypeSymbol)symbol.Type).DelegateInvokeMethod!;
+                if (!invokeMethod.ReturnsVoid)
+                    throw new NotSupportedException($"Delegate {symbol.Type.Name} must return void to be bound to a JS function");
+
+                string? binder;
+                if (!param.TryGetCLangBinder(Context, out binder))
+                    throw new Exception("Unable to find binder");
+
+                // The binding site is the parameter, shared by all the variants of the method.
+                // The function is owned by the HandleRef of the first wrapper argument, if any
+                // e.g. BindCallback<SLProgressCallback, struct NAPI_SLDocSetProgressCallback_callback>(env, args[1], args[0])
+                int ownerIndex = getCallbackOwnerIndex();
+                Builder.Append($"BindCallback<{binder}, struct {Item.GetNAPIMethodName()}_{param.Identifier.Text}>")
+                    .Parenthesized().Append("env").CommaSeparator().Append($"args[{index}]").CommaSeparator()
+                    .Append(ownerIndex == -1 ? "nullptr" : $"args[{ownerIndex}]").Close();
+                break;
+            }
             default:
             {
                 var fullTypeName = symbol.Type.GetFullName();
@@ -299,6 +398,11 @@ class NAPITrampolineMethodWriter : CodeWriter<MethodDeclarationSyntax, NAPIModul
                             Builder.Append($"CreateCBStringFromNapiValue(env, args[{index}])");
                             break;
                         }
+                        case "CodeBinder.cbspan":
+                        {
+                            Builder.Append($"GetSpanFromNapiValue(env, args[{index}])");
+                            break;
+                        }
                         case "CodeBinder.cbbool":
                         {
                             Builder.Append($"GetBoolFromNapiValue(env, args[{index}])");
@@ -376,3 +480,248 @@ class NAPITrampolineMethodWriter : CodeWriter<MethodDeclarationSyntax, NAPIModul
         get { return Item.GetNAPIMethodName(); }
     }
 }
+
+/// <summary>
+/// Bulk entry point of a [BatchedRelease] method, eg. SLFreeDocumentBatch(handles: Float64Array | BigUint64Array, count: number)
+/// </summary>
+class NAPIBatchedReleaseMethodWriter : CodeWriter<MethodDeclarationSyntax, NAPIModuleConversion>
+{
+    public ConversionType ConversionType { get; private set; }
+
+    public NAPIBatchedReleaseMethodWriter(MethodDeclarationSyntax method, NAPIModuleConversion module, ConversionType conversionType)
+        : base(method, module)
+    {
+        ConversionType = conversionType;
+    }
+
+    protected override void Write()
+    {
+        Builder.Append("extern \"C\"").Space().Append("napi_value").Space();
+        Builder.Append(Item.GetNAPIBatchedReleaseMethodName()).AppendLine("(");
+        using (Builder.Indent())
+            Builder.Append("napi_env env, napi_callback_info info").Append(")");
+
+        if (ConversionType == ConversionType.Implementation)
+        {
+            using (Builder.AppendLine().Block())
+            {
+                Builder.Append($"CB_TRAMPOLINE_PROBE(\"{Item.GetCLangMethodName()}Batch\")").EndOfStatement();
+                Builder.Append($"ReleaseHandlesFromNapiValue(env, info, {Item.GetCLangMethodName()})").EndOfStatement();
+                Builder.Append("return nullptr").EndOfStatement();
+            }
+        }
+        else
+        {
+            Builder.EndOfStatement();
+        }
+    }
+}
+
+/// <summary>
+/// Promise returning entry point of an [Async] method, eg. SLPdfLoadFileAsync(filename, password)
+/// </summary>
+class NAPIAsyncMethodWriter : NAPITrampolineMethodWriter
+{
+    public NAPIAsyncMethodWriter(MethodDeclarationSyntax method, NAPIModuleConversion module, ConversionType conversionType)
+        : base(method, module, conversionType)
+    {
+    }
+
+    protected override void Write()
+    {
+        Builder.Append("extern \"C\"").Space().Append("napi_value").Space();
+        Builder.Append(Item.GetNAPIAsyncMethodName()).AppendLine("(");
+        using (Builder.Indent())
+            Builder.Append("napi_env env, napi_callback_info info").Append(")");
+
+        if (ConversionType == ConversionType.Implementation)
+        {
+            using (Builder.AppendLine().Block())
+            {
+                writeBody();
+            }
+        }
+        else
+        {
+            Builder.EndOfStatement();
+        }
+    }
+
+    void writeBody()
+    {
+        Builder.Append($"CB_TRAMPOLINE_PROBE(\"{Item.GetCLangMethodName()}Async\")").EndOfStatement();
+        Builder.AppendLine();
+
+        // Arguments are converted on the JS thread and captured by
+        // value by the lambdas run on the thread pool and on completion
+        var parameters = Item.ParameterList.Parameters;
+        if (parameters.Count != 0)
+        {
+            Builder.AppendLine($"size_t argc = {parameters.Count};");
+            Builder.AppendLine($"napi_value args[{parameters.Count}];");
+            Builder.AppendLine("napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);");
+            Builder.AppendLine($"assert(argc == {parameters.Count});");
+            Builder.AppendLine();
+
+            // Bind first the arguments whose conversion can throw, so an
+            // invalid argument is reported before copying the others
+            bool canThrow = false;
+            for (int i = 0; i < parameters.Count; i++)
+            {
+                if (!canAsyncParameterThrow(parameters[i].GetDeclaredSymbol<IParameterSymbol>(Context)))
+                    continue;
+
+                bindAsyncParameter(parameters[i], i);
+                canThrow = true;
+            }
+
+            if (canThrow)
+            {
+                Builder.AppendLine();
+                Builder.Append("if (IsJSExceptionPending(env))").AppendLine();
+                Builder.IndentChild().Append("return nullptr").EndOfStatement().Close();
+                Builder.AppendLine();
+            }
+
+            for (int i = 0; i < parameters.Count; i++)
+            {
+                if (!canAsyncParameterThrow(parameters[i].GetDeclaredSymbol<IParameterSymbol>(Context)))
+                    bindAsyncParameter(parameters[i], i);
+            }
+
+            Builder.AppendLine();
+        }
+
+        var methodSymbol = Item.GetDeclaredSymbol<IMethodSymbol>(Context);
+        Builder.Append("return QueueAsyncCall(env,").Space().Append($"\"{Item.GetCLangMethodName()}Async\"").Append(",").Space()
+            .Append(parameters.Count == 0 ? "nullptr, 0" : $"args, {parameters.Count}").AppendLine(",");
+        using (Builder.Indent())
+        {
+            Builder.AppendLine("[=]() {");
+            using (Builder.Indent())
+            {
+                Builder.Append(methodSymbol.ReturnsVoid ? "" : "return ").Append(Item.GetCLangMethodName());
+                using (Builder.ParameterList())
+                {
+                    bool first = true;
+                    foreach (var param in parameters)
+                        Builder.CommaSeparator(ref first).Append(param.Identifier.Text);
+                }
+                Builder.EndOfStatement();
+            }
+            Builder.AppendLine("},");
+
+            Builder.Append(methodSymbol.ReturnsVoid ? "[=](napi_env env, napi_value* pins_) mutable {" : "[=](napi_env env, napi_value* pins_, auto& cret_) mutable {").AppendLine();
+            using (Builder.Indent())
+            {
+                if (!parameters.Any((param) => isAsyncBuffer(param.GetDeclaredSymbol<IParameterSymbol>(Context))))
+                    Builder.Append("(void)pins_").EndOfStatement();
+
+                for (int i = 0; i < parameters.Count; i++)
+                    releaseAsyncParameter(parameters[i], i);
+
+                writeReturn(methodSymbol);
+            }
+            Builder.Append("})").EndOfStatement();
+        }
+    }
+
+    void bindAsyncParameter(ParameterSyntax param, int index)
+    {
+        var symbol = param.GetDeclaredSymbol<IParameterSymbol>(Context);
+        if (symbol.IsRefLike())
+            throw new NotSupportedException($"By reference parameter {param.Identifier.Text} is unsupported in [Async] method {Item.GetName()}");
+
+        if (symbol.Type.TypeKind == TypeKind.Array)
+        {
+            // e.g. auto buffer = AsyncArray<const uint8_t>(env, args[0])
+            var arrayType = (IArrayTypeSymbol)symbol.Type;
+            bool commit = symbol.HasAttribute<OutAttribute>();
+            Builder.Append("auto").Space().Append(param.Identifier.Text).Space().Append("=").Space()
+                .Append("AsyncArray").AngleBracketed().Append($"{(commit ? "" : "const ")}{arrayType.ElementType.GetCLangType()}").Close()
+                .Append($"(env, args[{index}])").EndOfStatement();
+            return;
+        }
+
+        if (symbol.Type.GetFullName() == "CodeBinder.cbspan")
+        {
+            // e.g. auto data = AsyncSpan(env, args[0])
+            Builder.Append("auto").Space().Append(param.Identifier.Text).Space().Append("=").Space()
+                .Append($"AsyncSpan(env, args[{index}])").EndOfStatement();
+            return;
+        }
+
+        if (symbol.Type.GetFullName() == "CodeBinder.cbstring")
+        {
+            // e.g. auto filename = AsyncString(env, args[0])
+            Builder.Append("auto").Space().Append(param.Identifier.Text).Space().Append("=").Space()
+                .Append($"AsyncString(env, args[{index}])").EndOfStatement();
+            return;
+        }
+
+        bindParameter(param, index);
+    }
+
+    // Conversions that throw a JS exception on invalid arguments
+    static bool canAsyncParameterThrow(IParameterSymbol symbol)
+    {
+        return isAsyncBuffer(symbol) || canParameterThrow(symbol);
+    }
+
+    // Arguments copied to native memory for the call, see AsyncBuffer
+    static bool isAsyncBuffer(IParameterSymbol symbol)
+    {
+        return symbol.Type.TypeKind == TypeKind.Array
+            || symbol.Type.GetFullName() == "CodeBinder.cbspan";
+    }
+
+    void releaseAsyncParameter(ParameterSyntax param, int index)
+    {
+        var symbol = param.GetDeclaredSymbol<IParameterSymbol>(Context);
+        if (symbol.Type.GetFullName() == "CodeBinder.cbspan")
+        {
+            Builder.Append(param.Identifier.Text).Append($".Release(env, pins_[{index}])").EndOfStatement();
+            return;
+        }
+
+        if (symbol.Type.TypeKind != TypeKind.Array)
+            return;
+
+        bool commit = symbol.HasAttribute<OutAttribute>();
+        Builder.Append(param.Identifier.Text).Append($".Release(env, pins_[{index}], {(commit ? "true" : "false")})").EndOfStatement();
+    }
+
+    void writeReturn(IMethodSymbol methodSymbol)
+    {
+        if (methodSymbol.ReturnsVoid)
+        {
+            Builder.Append("return (napi_value)nullptr").EndOfStatement();
+            return;
+        }
+
+        Builder.Append("return").Space();
+        if (methodSymbol.ReturnType.TypeKind == TypeKind.Enum)
+        {
+            Builder.Append("CreateNapiValue(env, (int32_t)cret_)").EndOfStatement();
+            return;
+        }
+
+        switch (methodSymbol.ReturnType.GetFullName())
+        {
+            case "CodeBinder.cbstring":
+            case "CodeBinder.cbbuffer":
+            case "CodeBinder.cbstringarray":
+            case "CodeBinder.cbspan":
+            {
+                // Move the value so it's released after the conversion
+                Builder.Append("CreateNapiValue(env, std::move(cret_))").EndOfStatement();
+                break;
+            }
+            default:
+            {
+                Builder.Append("CreateNapiValue(env, cret_)").EndOfStatement();
+                break;
+            }
+        }
+    }
+}
@@ -100,6 +100,17 @@ public class NAPIModuleConversion : TypeConversion<NAPIModuleContext, NAPICompil
             else
             {
                 builder.Append(new NAPITrampolineMethodWriter(method, this, conversionType));
+                if (method.HasAttribute<BatchedReleaseAttribute>(this))
+                {
+                    builder.AppendLine();
+                    builder.Append(new NAPIBatchedReleaseMethodWriter(method, this, conversionType));
+                }
+
+                if (method.HasAttribute<AsyncAttribute>(this))
+                {
+                    builder.AppendLine();
+                    builder.Append(new NAPIAsyncMethodWriter(method, this, conversionType));
+                }
             }
 
             if (condition != null)
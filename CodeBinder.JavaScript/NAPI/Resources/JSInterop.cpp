@@ -28,15 +28,102 @@ static Init s_init;
 
 namespace js
 {
-    extern napi_ref s_AddonThisRef;
+    static void FreeEnvState(napi_env env, void* data, void* hint)
+    {
+        (void)hint;
+        auto state = (EnvState*)data;
+        if (state->AddonThisRef != nullptr)
+            (void)napi_delete_reference(env, state->AddonThisRef);
+        if (state->InternedStringsRef != nullptr)
+            (void)napi_delete_reference(env, state->InternedStringsRef);
+
+        delete state;
+
+        // Join the reclamation threads, as the addon may be unloaded
+        // with the env. They are started again if other envs need them
+        cb::ShutdownReclaimer();
+    }
+
+    // NOTE: It must be called when the module is registered, before any
+    // other finalizer is added, as finalizers are run in reverse order
+    // of creation when the env is torn down
+    napi_status CreateEnvState(napi_env env)
+    {
+        // The module may be registered again in the same env
+        void* data;
+        napi_status status = napi_get_instance_data(env, &data);
+        if (status != napi_ok || data != nullptr)
+            return status;
+
+        auto state = new EnvState();
+        status = napi_set_instance_data(env, state, FreeEnvState, nullptr);
+        if (status != napi_ok)
+        {
+            delete state;
+            return status;
+        }
+
+        // Handles are released by finalizers on the JS thread
+        // of the env, which must never stall
+        cb::SetReclaimerFinalizerThread();
+        return status;
+    }
 
-    napi_value GetAddonThis()
+    EnvState& GetEnvState(napi_env env)
+    {
+        void* data;
+        napi_status status = napi_get_instance_data(env, &data);
+        assert(status == napi_ok && data != nullptr);
+        (void)status;
+        return *(EnvState*)data;
+    }
+
+    napi_value GetAddonThis(napi_env env)
     {
         napi_value addonThisObj;
-        napi_status status = napi_get_reference_value(s_Env, s_AddonThisRef, &addonThisObj);
+        napi_status status = napi_get_reference_value(env, GetEnvState(env).AddonThisRef, &addonThisObj);
         assert(status == napi_ok);
+        (void)status;
         return addonThisObj;
     }
+
+    napi_value GetInternedNapiString(napi_env env, const cbstring& str)
+    {
+        auto& state = GetEnvState(env);
+        napi_status status;
+        napi_value strings;
+        if (state.InternedStringsRef == nullptr)
+        {
+            status = napi_create_object(env, &strings);
+            assert(status == napi_ok);
+            status = napi_create_reference(env, strings, 1, &state.InternedStringsRef);
+            assert(status == napi_ok);
+        }
+        else
+        {
+            status = napi_get_reference_value(env, state.InternedStringsRef, &strings);
+            assert(status == napi_ok);
+        }
+
+        napi_value ret;
+        auto found = state.InternedStringIndices.find(str.data);
+        if (found == state.InternedStringIndices.end())
+        {
+            status = napi_create_string_utf8(env, str.data, CBStringGetLength(&str), &ret);
+            assert(status == napi_ok);
+            uint32_t index = (uint32_t)state.InternedStringIndices.size();
+            status = napi_set_element(env, strings, index, ret);
+            assert(status == napi_ok);
+            state.InternedStringIndices.insert({ str.data, index });
+        }
+        else
+        {
+            status = napi_get_element(env, strings, found->second, &ret);
+            assert(status == napi_ok);
+        }
+
+        return ret;
+    }
 }
 
 Init::Init()
@@ -60,6 +147,7 @@ Init::Init()
     LOAD_SYMBOL(module, napi_get_value_string_utf8);
     LOAD_SYMBOL(module, napi_create_string_utf8);
     LOAD_SYMBOL(module, napi_get_array_length);
+    LOAD_SYMBOL(module, napi_create_array_with_length);
     LOAD_SYMBOL(module, napi_get_value_bool);
     LOAD_SYMBOL(module, napi_get_value_uint32);
     LOAD_SYMBOL(module, napi_get_value_int32);
@@ -79,10 +167,13 @@ Init::Init()
     LOAD_SYMBOL(module, napi_create_external);
     LOAD_SYMBOL(module, napi_get_named_property);
     LOAD_SYMBOL(module, napi_set_named_property);
+    LOAD_SYMBOL(module, napi_get_element);
+    LOAD_SYMBOL(module, napi_set_element);
     LOAD_SYMBOL(module, napi_define_properties);
     LOAD_SYMBOL(module, napi_call_function);
     LOAD_SYMBOL(module, napi_new_instance);
     LOAD_SYMBOL(module, napi_is_exception_pending);
+    LOAD_SYMBOL(module, napi_get_and_clear_last_exception);
     LOAD_SYMBOL(module, napi_reference_ref);
     LOAD_SYMBOL(module, napi_reference_unref);
     LOAD_SYMBOL(module, napi_create_reference);
@@ -93,4 +184,21 @@ Init::Init()
     LOAD_SYMBOL(module, napi_add_finalizer);
     LOAD_SYMBOL(module, napi_get_reference_value);
     LOAD_SYMBOL(module, napi_get_last_error_info);
+    LOAD_SYMBOL(module, napi_set_instance_data);
+    LOAD_SYMBOL(module, napi_get_instance_data);
+    LOAD_SYMBOL(module, napi_wrap);
+    LOAD_SYMBOL(module, napi_unwrap);
+    LOAD_SYMBOL(module, napi_create_error);
+    LOAD_SYMBOL(module, napi_create_promise);
+    LOAD_SYMBOL(module, napi_resolve_deferred);
+    LOAD_SYMBOL(module, napi_reject_deferred);
+    LOAD_SYMBOL(module, napi_create_async_work);
+    LOAD_SYMBOL(module, napi_queue_async_work);
+    LOAD_SYMBOL(module, napi_delete_async_work);
+    LOAD_SYMBOL(module, napi_open_handle_scope);
+    LOAD_SYMBOL(module, napi_close_handle_scope);
+    LOAD_SYMBOL(module, napi_create_threadsafe_function);
+    LOAD_SYMBOL(module, napi_call_threadsafe_function);
+    LOAD_SYMBOL(module, napi_release_threadsafe_function);
+    LOAD_SYMBOL(module, napi_unref_threadsafe_function);
 }
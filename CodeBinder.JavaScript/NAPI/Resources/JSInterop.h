@@ -5,10 +5,16 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstring>
+#include <memory>
+#include <mutex>
+#include <tuple>
 #include <vector>
 #include <type_traits>
+#include <unordered_map>
 
 #include "JSNAPI.h"
 
@@ -29,8 +35,6 @@ constexpr bool always_false = false;
 
 namespace js
 {
-    extern napi_env s_Env;
-
     // Alias napi symbols
     DECLARE_SYMBOL(napi_typeof);
     DECLARE_SYMBOL(napi_get_cb_info);
@@ -45,6 +49,7 @@ namespace js
     DECLARE_SYMBOL(napi_get_value_string_utf8);
     DECLARE_SYMBOL(napi_create_string_utf8);
     DECLARE_SYMBOL(napi_get_array_length);
+    DECLARE_SYMBOL(napi_create_array_with_length);
     DECLARE_SYMBOL(napi_get_value_bool);
     DECLARE_SYMBOL(napi_get_value_uint32);
     DECLARE_SYMBOL(napi_get_value_int32);
@@ -64,10 +69,13 @@ namespace js
     DECLARE_SYMBOL(napi_create_external);
     DECLARE_SYMBOL(napi_get_named_property);
     DECLARE_SYMBOL(napi_set_named_property);
+    DECLARE_SYMBOL(napi_get_element);
+    DECLARE_SYMBOL(napi_set_element);
     DECLARE_SYMBOL(napi_define_properties);
     DECLARE_SYMBOL(napi_call_function);
     DECLARE_SYMBOL(napi_new_instance);
     DECLARE_SYMBOL(napi_is_exception_pending);
+    DECLARE_SYMBOL(napi_get_and_clear_last_exception);
     DECLARE_SYMBOL(napi_reference_ref);
     DECLARE_SYMBOL(napi_reference_unref);
     DECLARE_SYMBOL(napi_create_reference);
@@ -78,6 +86,23 @@ namespace js
     DECLARE_SYMBOL(napi_add_finalizer);
     DECLARE_SYMBOL(napi_get_reference_value);
     DECLARE_SYMBOL(napi_get_last_error_info);
+    DECLARE_SYMBOL(napi_set_instance_data);
+    DECLARE_SYMBOL(napi_get_instance_data);
+    DECLARE_SYMBOL(napi_wrap);
+    DECLARE_SYMBOL(napi_unwrap);
+    DECLARE_SYMBOL(napi_create_error);
+    DECLARE_SYMBOL(napi_create_promise);
+    DECLARE_SYMBOL(napi_resolve_deferred);
+    DECLARE_SYMBOL(napi_reject_deferred);
+    DECLARE_SYMBOL(napi_create_async_work);
+    DECLARE_SYMBOL(napi_queue_async_work);
+    DECLARE_SYMBOL(napi_delete_async_work);
+    DECLARE_SYMBOL(napi_open_handle_scope);
+    DECLARE_SYMBOL(napi_close_handle_scope);
+    DECLARE_SYMBOL(napi_create_threadsafe_function);
+    DECLARE_SYMBOL(napi_call_threadsafe_function);
+    DECLARE_SYMBOL(napi_release_threadsafe_function);
+    DECLARE_SYMBOL(napi_unref_threadsafe_function);
 
     // Adapter class to find the correct typed array type
     template <typename TNArray>
@@ -90,7 +115,23 @@ namespace js
         }
     };
 
-    napi_value GetAddonThis();
+    // Binding state of a single environment, that is the main thread or
+    // a worker thread. It's stored as the env instance data, so workers
+    // don't share any state and don't need locking
+    struct EnvState
+    {
+        napi_ref AddonThisRef = nullptr;
+
+        // Interned strings are immortal, so their JS counterparts are cached
+        // by data pointer, as elements of an array object kept alive by a reference
+        napi_ref InternedStringsRef = nullptr;
+        std::unordered_map<const char*, uint32_t> InternedStringIndices;
+    };
+
+    napi_status CreateEnvState(napi_env env);
+    EnvState& GetEnvState(napi_env env);
+    napi_value GetAddonThis(napi_env env);
+    napi_value GetInternedNapiString(napi_env env, const cbstring& str);
 
     inline bool IsNull(napi_env env, napi_value value)
     {
@@ -102,6 +143,13 @@ namespace js
         return ret;
     }
 
+    inline bool IsJSExceptionPending(napi_env env)
+    {
+        bool ret;
+        napi_is_exception_pending(env, &ret);
+        return ret;
+    }
+
     inline bool IsUndefined(napi_env env, napi_value value)
     {
         napi_value undefvalue;
@@ -209,24 +257,70 @@ namespace js
         return (double)ret;
     }
 
-    inline void* GetHandleRefPtrFromNapiValue(napi_env env, napi_value value)
+    // Pointers are exchanged as JS numbers with the integer value of the
+    // address, which is exact up to 2^53. Higher addresses, eg. with
+    // tagged top bytes, are exchanged as BigInt values
+    constexpr uint64_t MaxNapiNumberPtr = (uint64_t)1 << 53;
+
+    inline bool IsNapiNumberPtr(const void* ptr)
     {
-        napi_value napi_ptr;
-        napi_get_named_property(env, value, "handle", &napi_ptr);
+        return (uint64_t)(uintptr_t)ptr <= MaxNapiNumberPtr;
+    }
 
-        double ret;
-        napi_get_value_double(env, napi_ptr, &ret);
-        return (void*)reinterpret_cast<uint64_t&>(ret);
+    inline double EncodeNapiPtr(const void* ptr)
+    {
+        assert(IsNapiNumberPtr(ptr));
+        return (double)(uintptr_t)ptr;
+    }
+
+    inline void* DecodeNapiPtr(double value)
+    {
+        return (void*)(uintptr_t)value;
     }
 
     inline void* GetPtrFromNapiValue(napi_env env, napi_value value)
     {
         double ret;
-        napi_get_value_double(env, value, &ret);
-        return (void*)reinterpret_cast<uint64_t&>(ret);
+        if (napi_get_value_double(env, value, &ret) == napi_ok)
+            return DecodeNapiPtr(ret);
+
+        uint64_t bigint = 0;
+        bool lossless;
+        napi_get_value_bigint_uint64(env, value, &bigint, &lossless);
+        return (void*)(uintptr_t)bigint;
+    }
+
+    // HandleRef objects returned by HandledObjectBase.handle have the
+    // native pointer attached with napi_wrap, which is read without
+    // any property lookup. Other objects fall back to the "handle" property
+    inline void* GetHandleRefPtrFromNapiValue(napi_env env, napi_value value)
+    {
+        void* ret;
+        if (napi_unwrap(env, value, &ret) == napi_ok)
+            return ret;
+
+        napi_value napi_ptr;
+        napi_get_named_property(env, value, "handle", &napi_ptr);
+        return GetPtrFromNapiValue(env, napi_ptr);
     }
 
     inline cbstring CreateCBStringFromNapiValue(napi_env env, napi_value str)
+    {
+        if (IsNull(env, str))
+            return cbstring{ };
+
+        size_t len;
+        napi_get_value_string_utf8(env, str, nullptr, 0, &len);
+        cbstring ret = cb::CreateScratchStringFixed(len);
+        napi_get_value_string_utf8(env, str, (char*)ret.data, len + 1, nullptr);
+        CB_TRAMPOLINE_BYTES(len);
+        return ret;
+    }
+
+    // Strings passed to asynchronous calls must outlive the scratch
+    // arena of the trampoline, so they are always heap allocated.
+    // Like any owned string, they are released by the native call
+    inline cbstring CreateOwnedCBStringFromNapiValue(napi_env env, napi_value str)
     {
         if (IsNull(env, str))
             return cbstring{ };
@@ -235,6 +329,7 @@ namespace js
         napi_get_value_string_utf8(env, str, nullptr, 0, &len);
         cbstring ret = CBCreateStringFixed(len);
         napi_get_value_string_utf8(env, str, (char*)ret.data, len + 1, nullptr);
+        CB_TRAMPOLINE_BYTES(len);
         return ret;
     }
 
@@ -317,42 +412,273 @@ namespace js
 
     inline napi_value CreateNapiValue(napi_env env, const cbstring& str)
     {
+        CB_TRAMPOLINE_BYTES(CBSLEN(str));
+        if (CBStringIsInterned(&str))
+            return GetInternedNapiString(env, str);
+
         napi_value ret;
         napi_create_string_utf8(env, str.data, CBStringGetLength(&str), &ret);
         return ret;
     }
 
-    inline napi_value CreateNapiValue(napi_env env, const void* ptr)
+    // Move semantics
+    inline napi_value CreateNapiValue(napi_env env, cbstring&& str)
     {
-        napi_value ret;
-        napi_create_double(env, *reinterpret_cast<const double*>((const uint64_t*)&ptr), &ret);
+        napi_value ret = CreateNapiValue(env, (const cbstring&)str);
+        CBFreeString(&str);
         return ret;
     }
 
-    inline bool IsJSExceptionPending(napi_env env)
+    // Release function of native memory handed over to the engine
+    typedef void (*NativeMemoryRelease)(void* data);
+
+    // Expose native memory as an ArrayBuffer without copying it. The engine
+    // invokes release when the buffer is collected, while a null release
+    // borrows the memory, which then must outlive the buffer. If the runtime
+    // disallows external buffers, eg. Electron, the memory is copied instead
+    // and released right away. On failure the memory is released as well,
+    // a JS exception is left pending and null is returned
+    inline napi_value CreateArrayBuffer(napi_env env, void* data, size_t size, NativeMemoryRelease release)
     {
-        bool ret;
-        napi_is_exception_pending(env, &ret);
+        napi_value ret;
+        napi_status status;
+        if (release == nullptr)
+        {
+            status = napi_create_external_arraybuffer(env, data, size, nullptr, nullptr, &ret);
+        }
+        else
+        {
+            // The release function travels as the finalize hint
+            status = napi_create_external_arraybuffer(env, data, size, [](napi_env env, void* data, void* hint) {
+                (void)env;
+                ((NativeMemoryRelease)hint)(data);
+            }, (void*)release, &ret);
+        }
+
+        if (status == napi_no_external_buffers_allowed)
+        {
+            void* copy;
+            status = napi_create_arraybuffer(env, size, &copy, &ret);
+            if (status == napi_ok)
+                std::memcpy(copy, data, size);
+
+            if (release != nullptr)
+                release(data);
+        }
+        else if (status != napi_ok && release != nullptr)
+        {
+            // The engine didn't take the ownership of the memory
+            release(data);
+        }
+
+        if (status != napi_ok)
+        {
+            if (!IsJSExceptionPending(env))
+                napi_throw_error(env, nullptr, "Could not create the ArrayBuffer");
+
+            return nullptr;
+        }
+
         return ret;
     }
 
-    template <typename TNArray>
-    inline napi_value CreateNapiValue(napi_env env, TNArray* arr, size_t size)
+    // Buffers of any element kind are exposed as an Uint8Array
+    inline napi_value CreateNapiValue(napi_env env, cbbuffer&& buf)
     {
+        napi_value ret;
+        if (buf.data == nullptr)
+        {
+            napi_get_null(env, &ret);
+            return ret;
+        }
+
+        size_t size = CBBufferGetByteSize(&buf);
+        CB_TRAMPOLINE_BYTES(size);
         napi_value arrayBuffer;
-        napi_status status = napi_create_external_arraybuffer(env, (void*)arr, size, nullptr, nullptr, &arrayBuffer);
-        if (status == napi_no_external_buffers_allowed)
+        if ((buf.opaque & CB_BUFFER_OWNSDATA_FLAG) != 0)
+        {
+            // Hand the data over to the engine, which frees it when collected
+            arrayBuffer = CreateArrayBuffer(env, buf.data, size, CBFreeMemory);
+            buf = cbbuffernull;
+            if (arrayBuffer == nullptr)
+                return nullptr;
+        }
+        else
         {
+            // Views are copied, since they may not outlive the call
             void* data;
-            napi_create_arraybuffer(env, size, &data, &arrayBuffer);
-            std::memcpy(data, arr, size * sizeof(TNArray));
+            if (napi_create_arraybuffer(env, size, &data, &arrayBuffer) != napi_ok)
+            {
+                if (!IsJSExceptionPending(env))
+                    napi_throw_error(env, nullptr, "Could not create the ArrayBuffer");
+
+                return nullptr;
+            }
+
+            std::memcpy(data, buf.data, size);
+        }
+
+        napi_create_typedarray(env, napi_uint8_array, size, arrayBuffer, 0, &ret);
+        return ret;
+    }
+
+    // Spans are exposed as an Uint8Array. Owned memory is handed over
+    // to the engine, views are copied since they may not outlive the call
+    inline napi_value CreateNapiValue(napi_env env, cbspan&& span)
+    {
+        cbbuffer buf = { span.data, span.opaque, CB_ELEMENT_UINT8 };
+        span = cbspannull;
+        return CreateNapiValue(env, std::move(buf));
+    }
+
+    inline size_t GetTypedArrayElementSize(napi_typedarray_type type)
+    {
+        switch (type)
+        {
+            case napi_int16_array:
+            case napi_uint16_array:
+                return 2;
+            case napi_int32_array:
+            case napi_uint32_array:
+            case napi_float32_array:
+                return 4;
+            case napi_float64_array:
+            case napi_bigint64_array:
+            case napi_biguint64_array:
+                return 8;
+            default:
+                return 1;
+        }
+    }
+
+    // Get the memory of a typed array of any element kind. Other
+    // values throw a TypeError and return false
+    inline bool GetTypedArrayMemory(napi_env env, napi_value value, void*& data, size_t& size)
+    {
+        napi_typedarray_type type;
+        size_t length;
+        if (napi_get_typedarray_info(env, value, &type, &length, &data, nullptr, nullptr) != napi_ok)
+        {
+            napi_throw_type_error(env, nullptr, "A typed array was expected");
+            return false;
         }
 
+        size = length * GetTypedArrayElementSize(type);
+        return true;
+    }
+
+    // Borrow the memory of a typed array of any element kind, without copying.
+    // Other values throw a TypeError and return a null span
+    inline cbspan GetSpanFromNapiValue(napi_env env, napi_value value)
+    {
+        if (IsNull(env, value))
+            return cbspannull;
+
+        void* data;
+        size_t size;
+        if (!GetTypedArrayMemory(env, value, data, size))
+            return cbspannull;
+
+        return CBCreateSpanView(data, size);
+    }
+
+    // Release a batch of handles collected by an HandleReleaseQueue with a
+    // single call. The handles are passed in a Float64Array, with the
+    // encoding of EncodeNapiPtr, or in a BigUint64Array if any of them
+    // doesn't fit a number, followed by their count
+    template <typename THandle>
+    void ReleaseHandlesFromNapiValue(napi_env env, napi_callback_info info, void(*release)(THandle))
+    {
+        size_t argc = 2;
+        napi_value args[2];
+        napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+        assert(argc == 2);
+
+        napi_typedarray_type type;
+        size_t length;
+        void* data;
+        napi_get_typedarray_info(env, args[0], &type, &length, &data, nullptr, nullptr);
+        uint32_t count;
+        napi_get_value_uint32(env, args[1], &count);
+        assert(count <= length);
+        if (type == napi_biguint64_array)
+        {
+            for (size_t i = 0; i < count; i++)
+                release((THandle)(uintptr_t)((const uint64_t*)data)[i]);
+        }
+        else
+        {
+            assert(type == napi_float64_array);
+            for (size_t i = 0; i < count; i++)
+                release((THandle)DecodeNapiPtr(((const double*)data)[i]));
+        }
+    }
+
+    inline napi_value CreateNapiValue(napi_env env, cbstringarray&& arr)
+    {
         napi_value ret;
+        if (arr.data == nullptr)
+        {
+            napi_get_null(env, &ret);
+            return ret;
+        }
+
+        size_t count = CBStringArrayGetCount(&arr);
+        napi_create_array_with_length(env, count, &ret);
+        for (size_t i = 0; i < count; i++)
+        {
+            auto str = CBStringArrayGet(&arr, i);
+            napi_value value;
+            napi_create_string_utf8(env, str.data, CBSLEN(str), &value);
+            napi_set_element(env, ret, (uint32_t)i, value);
+            CB_TRAMPOLINE_BYTES(CBSLEN(str));
+        }
+
+        CBFreeStringArray(&arr);
+        return ret;
+    }
+
+    inline napi_value CreateNapiValue(napi_env env, const void* ptr)
+    {
+        napi_value ret;
+        if (IsNapiNumberPtr(ptr))
+            napi_create_double(env, EncodeNapiPtr(ptr), &ret);
+        else
+            napi_create_bigint_uint64(env, (uint64_t)(uintptr_t)ptr, &ret);
+
+        return ret;
+    }
+
+    // Expose a native array of the given element count as a typed array,
+    // without copying it. The ownership of the memory is transferred to the
+    // engine, which invokes release when the array is collected, see CreateArrayBuffer
+    template <typename TNArray>
+    inline napi_value CreateNapiValue(napi_env env, TNArray* arr, size_t size, NativeMemoryRelease release)
+    {
+        napi_value ret;
+        if (arr == nullptr)
+        {
+            napi_get_null(env, &ret);
+            return ret;
+        }
+
+        size_t byteSize = size * sizeof(TNArray);
+        CB_TRAMPOLINE_BYTES(byteSize);
+        napi_value arrayBuffer = CreateArrayBuffer(env, (void*)arr, byteSize, release);
+        if (arrayBuffer == nullptr)
+            return nullptr;
+
         napi_create_typedarray(env, TArrShim<typename std::remove_const<TNArray>::type>::GetType(), size, arrayBuffer, 0, &ret);
         return ret;
     }
 
+    // Borrowing variant: the memory must outlive the array, eg. a static table
+    template <typename TNArray>
+    inline napi_value CreateNapiValue(napi_env env, TNArray* arr, size_t size)
+    {
+        return CreateNapiValue(env, arr, size, nullptr);
+    }
+
     // Adapter class to link correct JNI methods
     template <typename TNArray>
     struct AJSShim
@@ -362,6 +688,7 @@ namespace js
             void* data;
             size_t length;
             napi_get_typedarray_info(env, arr, nullptr, &length, &data, nullptr, nullptr);
+            CB_TRAMPOLINE_BYTES(length * sizeof(TNArray));
             return (TNArray*)data;
         }
 
@@ -414,6 +741,566 @@ namespace js
         inline operator TCArray* () const { return (TCArray*)AJS2N<TNArray, Args...>::n_array(); }
     };
 
+    // Native copy of a typed array argument of an asynchronous call. The JS
+    // memory can't be accessed from the thread pool, since pinning the array
+    // doesn't prevent its buffer from being detached and JS can write to it
+    // concurrently. The copy is taken on the JS thread and, when committing,
+    // copied back on completion. Copies share the same memory, so the buffer
+    // can be captured by value by the lambdas of the call
+    class AsyncBuffer
+    {
+    public:
+        AsyncBuffer(napi_env env, napi_value arr)
+            : m_size(0)
+        {
+            if (IsNull(env, arr))
+                return;
+
+            void* data;
+            if (!GetTypedArrayMemory(env, arr, data, m_size))
+                return;
+
+            // Always allocate, so empty arrays are still distinguished from null
+            m_buffer = std::make_shared<std::vector<uint8_t>>(m_size == 0 ? 1 : m_size);
+            if (m_size != 0)
+                std::memcpy(m_buffer->data(), data, m_size);
+
+            CB_TRAMPOLINE_BYTES(m_size);
+        }
+    public:
+        // Copy the native memory back to the array. The array may have
+        // been detached or resized meanwhile: copy what still fits
+        void Commit(napi_env env, napi_value arr) const
+        {
+            if (m_buffer == nullptr || arr == nullptr)
+                return;
+
+            napi_typedarray_type type;
+            size_t length;
+            void* data;
+            if (napi_get_typedarray_info(env, arr, &type, &length, &data, nullptr, nullptr) != napi_ok
+                || data == nullptr)
+            {
+                return;
+            }
+
+            size_t size = std::min(length * GetTypedArrayElementSize(type), m_size);
+            std::memcpy(data, m_buffer->data(), size);
+            CB_TRAMPOLINE_BYTES(size);
+        }
+
+        inline void* data() const { return m_buffer == nullptr ? nullptr : m_buffer->data(); }
+        inline size_t size() const { return m_size; }
+    private:
+        std::shared_ptr<std::vector<uint8_t>> m_buffer;
+        size_t m_size;
+    };
+
+    // Array argument of an asynchronous call, see AsyncBuffer
+    template <typename TNArray>
+    class AsyncArray
+    {
+    public:
+        AsyncArray(napi_env env, napi_value arr)
+            : m_buffer(env, arr) { }
+    public:
+        void Release(napi_env env, napi_value arr, bool commit) const
+        {
+            if (commit)
+                m_buffer.Commit(env, arr);
+        }
+        inline operator TNArray* () const { return (TNArray*)m_buffer.data(); }
+    private:
+        AsyncBuffer m_buffer;
+    };
+
+    // Span argument of an asynchronous call, see AsyncBuffer. The native
+    // function can write to the span, so the memory is always copied back
+    class AsyncSpan
+    {
+    public:
+        AsyncSpan(napi_env env, napi_value arr)
+            : m_buffer(env, arr) { }
+    public:
+        void Release(napi_env env, napi_value arr) const
+        {
+            m_buffer.Commit(env, arr);
+        }
+        inline operator cbspan () const
+        {
+            if (m_buffer.data() == nullptr)
+                return cbspannull;
+
+            return CBCreateSpanView(m_buffer.data(), m_buffer.size());
+        }
+    private:
+        AsyncBuffer m_buffer;
+    };
+
+    // Owned string argument of an asynchronous call, see
+    // CreateOwnedCBStringFromNapiValue. The ownership is handed over to the
+    // native call, which releases the string, when the call is executed.
+    // If the work is cancelled the string is released on completion instead.
+    // Copies share the same string, so it can be captured by value
+    class AsyncString
+    {
+    public:
+        AsyncString(napi_env env, napi_value str)
+            : m_string(std::make_shared<Owned>(CreateOwnedCBStringFromNapiValue(env, str))) { }
+    public:
+        // Hand over the string to the native call
+        inline operator cbstring () const
+        {
+            cbstring ret = m_string->Value;
+            m_string->Value = cbstringnull;
+            return ret;
+        }
+    private:
+        struct Owned
+        {
+            Owned(cbstring value)
+                : Value(value) { }
+
+            ~Owned()
+            {
+                CBFreeString(&Value);
+            }
+
+            cbstring Value;
+        };
+
+        std::shared_ptr<Owned> m_string;
+    };
+
+    // Native call of an [Async] method. The arguments are converted on the JS
+    // thread, execute runs on the libuv thread pool and complete runs back on
+    // the JS thread, where it converts the result and releases the arguments
+    template <typename TExecute, typename TComplete>
+    class AsyncCall final
+    {
+        using TResult = decltype(std::declval<TExecute&>()());
+        using TStorage = std::conditional_t<std::is_void_v<TResult>, std::nullptr_t, TResult>;
+    public:
+        AsyncCall(TExecute&& execute, TComplete&& complete)
+            : m_deferred(nullptr), m_work(nullptr), m_execute(std::move(execute)),
+            m_complete(std::move(complete)), m_result{ } { }
+    public:
+        napi_value Queue(napi_env env, const char* name, const napi_value* args, size_t argc)
+        {
+            // Pin the object arguments, eg. the HandleRef of the wrapper
+            // owning an handle or an array accessed natively
+            for (size_t i = 0; i < argc; i++)
+            {
+                napi_valuetype type;
+                napi_ref ref = nullptr;
+                napi_typeof(env, args[i], &type);
+                if (type == napi_object)
+                    napi_create_reference(env, args[i], 1, &ref);
+
+                m_pins.push_back(ref);
+            }
+
+            napi_status status;
+            napi_value promise;
+            status = napi_create_promise(env, &m_deferred, &promise);
+            assert(status == napi_ok);
+
+            napi_value resourceName;
+            status = napi_create_string_utf8(env, name, NAPI_AUTO_LENGTH, &resourceName);
+            assert(status == napi_ok);
+            status = napi_create_async_work(env, nullptr, resourceName, execute, complete, this, &m_work);
+            assert(status == napi_ok);
+            status = napi_queue_async_work(env, m_work);
+            assert(status == napi_ok);
+            (void)status;
+            return promise;
+        }
+    private:
+        static void execute(napi_env env, void* data)
+        {
+            (void)env;
+            auto call = (AsyncCall*)data;
+            if constexpr (std::is_void_v<TResult>)
+                call->m_execute();
+            else
+                call->m_result = call->m_execute();
+        }
+
+        static void complete(napi_env env, napi_status status, void* data)
+        {
+            std::unique_ptr<AsyncCall> call((AsyncCall*)data);
+            std::vector<napi_value> pins(call->m_pins.size());
+            for (size_t i = 0; i < pins.size(); i++)
+            {
+                if (call->m_pins[i] == nullptr)
+                    pins[i] = nullptr;
+                else
+                    napi_get_reference_value(env, call->m_pins[i], &pins[i]);
+            }
+
+            // The arguments are released even if the call was cancelled
+            napi_value result;
+            if constexpr (std::is_void_v<TResult>)
+                result = call->m_complete(env, pins.data());
+            else
+                result = call->m_complete(env, pins.data(), call->m_result);
+
+            if (status == napi_ok && IsJSExceptionPending(env))
+            {
+                // The conversion of the result failed
+                napi_value error;
+                napi_get_and_clear_last_exception(env, &error);
+                napi_reject_deferred(env, call->m_deferred, error);
+            }
+            else if (status == napi_ok)
+            {
+                if (result == nullptr)
+                    napi_get_undefined(env, &result);
+
+                napi_resolve_deferred(env, call->m_deferred, result);
+            }
+            else
+            {
+                napi_value message;
+                napi_value error;
+                napi_create_string_utf8(env, "The asynchronous call was cancelled", NAPI_AUTO_LENGTH, &message);
+                napi_create_error(env, nullptr, message, &error);
+                napi_reject_deferred(env, call->m_deferred, error);
+            }
+
+            for (auto ref : call->m_pins)
+            {
+                if (ref != nullptr)
+                    napi_delete_reference(env, ref);
+            }
+
+            napi_delete_async_work(env, call->m_work);
+        }
+    private:
+        napi_deferred m_deferred;
+        napi_async_work m_work;
+        std::vector<napi_ref> m_pins;
+        TExecute m_execute;
+        TComplete m_complete;
+        TStorage m_result;
+    };
+
+    // Queue an asynchronous call and return the Promise of its result
+    template <typename TExecute, typename TComplete>
+    napi_value QueueAsyncCall(napi_env env, const char* name, const napi_value* args, size_t argc,
+        TExecute execute, TComplete complete)
+    {
+        auto call = new AsyncCall<TExecute, TComplete>(std::move(execute), std::move(complete));
+        return call->Queue(env, name, args, argc);
+    }
+
+    // Argument of a native callback invocation. The invocation is delivered
+    // later on the JS thread, so the argument is captured by value
+    template <typename T>
+    struct CallbackArg
+    {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>,
+            "Unsupported callback argument type");
+
+        static T Capture(T value)
+        {
+            return value;
+        }
+
+        static napi_value Deliver(napi_env env, T& value)
+        {
+            if constexpr (std::is_enum_v<T>)
+                return CreateNapiValue(env, (int32_t)value);
+            else if constexpr (std::is_pointer_v<T>)
+                return CreateNapiValue(env, (const void*)value);
+            else
+                return CreateNapiValue(env, value);
+        }
+
+        static void Discard(T& value)
+        {
+            (void)value;
+        }
+    };
+
+    // Strings are copied, as the native data is usually valid only during the call
+    template <>
+    struct CallbackArg<cbstring>
+    {
+        static cbstring Capture(cbstring value)
+        {
+            if (value.data == nullptr || CBStringIsInterned(&value))
+                return value;
+
+            return CBCreateStringLen(value.data, CBStringGetLength(&value));
+        }
+
+        static napi_value Deliver(napi_env env, cbstring& value)
+        {
+            if (value.data == nullptr)
+            {
+                napi_value ret;
+                napi_get_null(env, &ret);
+                return ret;
+            }
+
+            return CreateNapiValue(env, std::move(value));
+        }
+
+        static void Discard(cbstring& value)
+        {
+            CBFreeString(&value);
+        }
+    };
+
+    template <typename TFunction, typename TTag>
+    class CallbackSlot;
+
+    // JS function bound to a native callback, that can be invoked from any
+    // thread. The invocations are queued and coalesced: at most one wake up
+    // of the JS thread is pending and it delivers all the invocations queued
+    // so far, so a burst of native invocations costs a few event loop turns
+    // instead of one each. The delivery is always deferred, even when invoked
+    // on the JS thread, hence only void returning callbacks are supported.
+    // TTag identifies the binding site, eg. a parameter of a native method.
+    // Native callbacks carry no user data, so there's a single function per
+    // site in the process: it's owned by the object that bound it, eg. the
+    // HandleRef of the wrapper passed to the method, in its environment.
+    // The owner can replace or unbind it, while binding from another owner
+    // fails until the function is unbound or its owner is collected
+    template <typename TTag, typename... TArgs>
+    class CallbackSlot<void(*)(TArgs...), TTag> final
+    {
+        using TItem = std::tuple<TArgs...>;
+    public:
+        // Native function pointer passed to the native code
+        static void Invoke(TArgs... args)
+        {
+            std::lock_guard<std::mutex> lock(s_mutex);
+            if (s_function == nullptr)
+                return;
+
+            s_pending.emplace_back(CallbackArg<TArgs>::Capture(args)...);
+            schedule();
+        }
+
+        // Bind the JS function, or unbind when null is passed. The owner can be null,
+        // for an owner that is the environment itself. It returns napi_invalid_arg
+        // when the function is owned by another object. It must be called on the JS thread
+        static napi_status Bind(napi_env env, napi_value value, napi_value owner)
+        {
+            std::unique_lock<std::mutex> lock(s_mutex);
+            bool unbind = IsNull(env, value);
+            if (s_function != nullptr && !isOwner(env, owner) && isOwnerAlive(env))
+                return unbind ? napi_ok : napi_invalid_arg;
+
+            napi_status status;
+            napi_threadsafe_function function = nullptr;
+            napi_ref ownerRef = nullptr;
+            if (!unbind)
+            {
+                napi_value resourceName;
+                status = napi_create_string_utf8(env, "CodeBinderCallback", NAPI_AUTO_LENGTH, &resourceName);
+                assert(status == napi_ok);
+
+                // The handle is set after the creation and it is the
+                // finalize data, to recognize the function when it's finalized
+                auto handle = new napi_threadsafe_function(nullptr);
+                status = napi_create_threadsafe_function(env, value, nullptr, resourceName,
+                    0, 1, handle, finalize, nullptr, callJS, &function);
+                if (status != napi_ok)
+                {
+                    delete handle;
+                    return status;
+                }
+
+                *handle = function;
+
+                // A bound callback must not keep the process alive
+                napi_unref_threadsafe_function(env, function);
+
+                // The owner is referenced weakly, to know when it's collected
+                if (owner != nullptr)
+                    napi_create_reference(env, owner, 0, &ownerRef);
+            }
+
+            // The reference of a previous owner of another
+            // environment is freed with its environment
+            if (s_owner != nullptr && s_env == env)
+                napi_delete_reference(env, s_owner);
+
+            napi_threadsafe_function previous = s_function;
+            s_function = function;
+            s_env = function == nullptr ? nullptr : env;
+            s_owner = ownerRef;
+            s_scheduled = false;
+            if (function == nullptr)
+                discard(s_pending);
+            else if (!s_pending.empty())
+                schedule();
+
+            lock.unlock();
+            if (previous != nullptr)
+                napi_release_threadsafe_function(previous, napi_tsfn_release);
+
+            return napi_ok;
+        }
+    private:
+        // Must be called with the lock held
+        static bool isOwner(napi_env env, napi_value owner)
+        {
+            if (s_env != env)
+                return false;
+
+            if (s_owner == nullptr)
+                return owner == nullptr;
+
+            napi_value current;
+            if (owner == nullptr || napi_get_reference_value(env, s_owner, &current) != napi_ok || current == nullptr)
+                return false;
+
+            bool ret;
+            napi_strict_equals(env, current, owner, &ret);
+            return ret;
+        }
+
+        // Must be called with the lock held. The owner of another environment
+        // can't be checked: its function is unbound when the environment is torn down
+        static bool isOwnerAlive(napi_env env)
+        {
+            if (s_env != env || s_owner == nullptr)
+                return true;
+
+            napi_value current;
+            return napi_get_reference_value(env, s_owner, &current) == napi_ok && current != nullptr;
+        }
+
+        // Must be called with the lock held
+        static void schedule()
+        {
+            if (s_scheduled)
+                return;
+
+            // The function travels as the call data, so a wake up
+            // of a function that was replaced in the meantime is ignored
+            if (napi_call_threadsafe_function(s_function, s_function, napi_tsfn_nonblocking) == napi_ok)
+                s_scheduled = true;
+        }
+
+        static void callJS(napi_env env, napi_value function, void* context, void* data)
+        {
+            (void)context;
+            std::vector<TItem> batch;
+            {
+                std::lock_guard<std::mutex> lock(s_mutex);
+                if (data != s_function)
+                    return;
+
+                s_scheduled = false;
+                batch.swap(s_pending);
+            }
+
+            // env is null when the function is being finalized
+            size_t i = 0;
+            if (env != nullptr)
+            {
+                napi_value recv;
+                napi_get_undefined(env, &recv);
+                while (i < batch.size())
+                {
+                    napi_handle_scope scope;
+                    napi_open_handle_scope(env, &scope);
+                    napi_status status = std::apply([&](TArgs&... args) {
+                        napi_value argv[sizeof...(TArgs) + 1];
+                        size_t argc = 0;
+                        ((argv[argc++] = CallbackArg<TArgs>::Deliver(env, args)), ...);
+                        return napi_call_function(env, recv, function, argc, argv, nullptr);
+                    }, batch[i]);
+                    napi_close_handle_scope(env, scope);
+                    i++;
+
+                    // A thrown exception is left pending, for node to handle
+                    // it as uncaught, and the remaining invocations are dropped
+                    if (status != napi_ok)
+                        break;
+                }
+            }
+
+            batch.erase(batch.begin(), batch.begin() + i);
+            discard(batch);
+        }
+
+        static void finalize(napi_env env, void* finalize_data, void* finalize_hint)
+        {
+            (void)env;
+            (void)finalize_hint;
+            std::unique_ptr<napi_threadsafe_function> handle((napi_threadsafe_function*)finalize_data);
+
+            // The function is still bound when its environment is torn down
+            std::lock_guard<std::mutex> lock(s_mutex);
+            if (s_function != *handle)
+                return;
+
+            s_function = nullptr;
+            s_env = nullptr;
+            s_owner = nullptr;
+            s_scheduled = false;
+            discard(s_pending);
+        }
+
+        static void discard(std::vector<TItem>& items)
+        {
+            for (auto& item : items)
+                std::apply([](TArgs&... args) { (CallbackArg<TArgs>::Discard(args), ...); }, item);
+
+            items.clear();
+        }
+    private:
+        static inline std::mutex s_mutex;
+        static inline napi_threadsafe_function s_function = nullptr;
+        static inline napi_env s_env = nullptr;
+        static inline napi_ref s_owner = nullptr;
+        static inline bool s_scheduled = false;
+        static inline std::vector<TItem> s_pending;
+    };
+
+    // Bind the JS function of a callback argument, returning the native
+    // function pointer or nullptr when the argument is null or undefined.
+    // The owner is the object the function is bound for, see CallbackSlot
+    template <typename TFunction, typename TTag>
+    TFunction BindCallback(napi_env env, napi_value value, napi_value owner)
+    {
+        napi_valuetype type;
+        napi_typeof(env, value, &type);
+        if (type == napi_null || type == napi_undefined)
+        {
+            napi_value nullval;
+            napi_get_null(env, &nullval);
+            CallbackSlot<TFunction, TTag>::Bind(env, nullval, owner);
+            return nullptr;
+        }
+
+        if (type != napi_function)
+        {
+            napi_throw_type_error(env, nullptr, "A function was expected");
+            return nullptr;
+        }
+
+        switch (CallbackSlot<TFunction, TTag>::Bind(env, value, owner))
+        {
+            case napi_ok:
+                break;
+            case napi_invalid_arg:
+                napi_throw_error(env, nullptr, "The callback is already bound by another object");
+                return nullptr;
+            default:
+                napi_throw_error(env, nullptr, "Could not bind the callback");
+                return nullptr;
+        }
+
+        return &CallbackSlot<TFunction, TTag>::Invoke;
+    }
+
     template <>
     struct TArrShim<uint8_t>
     {
@@ -754,10 +1641,7 @@ namespace js
         }
         static napi_value Release(napi_env env, cbstring nvalue)
         {
-            napi_value ret;
-            napi_create_string_utf8(env, nvalue.data, CBStringGetLength(&nvalue), &ret);
-            CBFreeString(&nvalue);
-            return ret;
+            return CreateNapiValue(env, std::move(nvalue));
         }
     };
 }
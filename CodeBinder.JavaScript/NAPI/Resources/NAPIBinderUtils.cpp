@@ -70,4 +70,21 @@ namespace js
 
         return ret;
     }
+
+    extern "C" napi_value NAPI_WrapHandleRef(
+        napi_env env, napi_callback_info info)
+    {
+        napi_status status;
+        size_t argc = 2;
+        napi_value args[2];
+        status = napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+        assert(status == napi_ok);
+
+        // The pointer is not owned, so no finalizer is needed
+        void* ptr = GetPtrFromNapiValue(env, args[1]);
+        status = napi_wrap(env, args[0], ptr, nullptr, nullptr, nullptr);
+        assert(status == napi_ok);
+
+        return nullptr;
+    }
 }
@@ -18,4 +18,7 @@ namespace js
 
     extern "C" napi_value NAPI_NativeHandleGetTarget(
         napi_env env, napi_callback_info info);
+
+    extern "C" napi_value NAPI_WrapHandleRef(
+        napi_env env, napi_callback_info info);
 }
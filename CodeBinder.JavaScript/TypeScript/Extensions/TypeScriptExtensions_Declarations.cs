@@ -34,6 +34,9 @@ static partial class TypeScriptExtensions
                 return new[] { new TypeScriptStructWriter(context.Structs[structure], partialDeclarations.ChildrenPartialDeclarations[structure]) };
             case SyntaxKind.EnumDeclaration:
                 return new[] { new TypeScriptEnumWriter(context.Enums[(EnumDeclarationSyntax)member]) };
+            case SyntaxKind.DelegateDeclaration:
+                // Written at top level, see TypeScriptDelegateWriter
+                return Array.Empty<CodeWriter>();
             default:
                 throw new NotSupportedException();
         }
@@ -415,6 +415,7 @@ static partial class TypeScriptExtensions
                             case TypeKind.Interface:
                             case TypeKind.TypeParameter:
                             case TypeKind.Array:
+                            case TypeKind.Delegate:
                                 var elementTypeSymbol = nullableType.ElementType.GetSymbol<ITypeSymbol>(context);
                                 writeTypeScriptType(builder, elementTypeSymbol.GetFullName(), nullableType.ElementType, elementTypeSymbol, false, true, context, out _);
                                 builder.Append(" | null");
@@ -481,6 +482,7 @@ static partial class TypeScriptExtensions
                         case TypeKind.Interface:
                         case TypeKind.TypeParameter:
                         case TypeKind.Array:
+                        case TypeKind.Delegate:
                             var elementTypeSymbol = nullableType.ElementType.GetSymbol<ITypeSymbol>(context);
                             writeTypeScriptType(builder, elementTypeSymbol.GetFullName(), nullableType.ElementType, elementTypeSymbol, false, true, context, out _);
                             builder.Append(" | null");
@@ -904,6 +906,13 @@ static partial class TypeScriptExtensions
                 case "System.String":
                     knownTypeScriptType = "string";
                     return true;
+                case "CodeBinder.cbbuffer":
+                case "CodeBinder.cbspan":
+                    knownTypeScriptType = "Uint8Array";
+                    return true;
+                case "CodeBinder.cbstringarray":
+                    knownTypeScriptType = "string[]";
+                    return true;
                 case "CodeBinder.cbbool":
                 case "System.Boolean":
                     knownTypeScriptType = "boolean";
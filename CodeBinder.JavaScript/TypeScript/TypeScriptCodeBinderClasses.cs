@@ -21,9 +21,11 @@ static class TypeScriptCodeBinderClasses
                 nameof(StringRefBox),
                 nameof(IObjectFinalizer),
                 nameof(HandledObjectFinalizer),
+                nameof(HandleReleaseQueue),
                 nameof(FinalizableObject),
                 nameof(HandledObjectBase),
                 nameof(HandledObject),
+                nameof(HandledObjectCache),
                 nameof(IDisposable),
                 nameof(IReadOnlyList),
                 nameof(KeyValuePair),
@@ -50,9 +52,11 @@ static class TypeScriptCodeBinderClasses
                 StringRefBox,
                 IObjectFinalizer,
                 HandledObjectFinalizer,
+                HandleReleaseQueue,
                 FinalizableObject,
                 HandledObjectBase,
                 HandledObject,
+                HandledObjectCache,
                 IDisposable,
                 IReadOnlyList,
                 KeyValuePair,
@@ -204,12 +208,13 @@ export class Exception extends Error
     const string HandleRef =
 """
 // https://docs.microsoft.com/en-us/dotnet/api/system.runtime.interopservices.handleref
+// Handles are numbers, or bigint values for addresses above 2^53
 export class HandleRef extends ObjectTS
 {
     wrapper: object | null;
-    handle: number;
+    handle: number | bigint;
 
-    constructor(wrapper?: object | null, handle?: number)
+    constructor(wrapper?: object | null, handle?: number | bigint)
     {
         super();
         this.wrapper = wrapper ?? null;
@@ -295,6 +300,124 @@ export interface IObjectFinalizer
  }
  """;
 
+    const string HandleReleaseQueue =
+"""
+// Accumulates the handles of collected objects and releases them in bulk
+// with a single native call. The queue is flushed when it reaches the
+// threshold or when the interval elapsed since the first pending handle.
+// Handles are stored in a Float64Array, which is switched to a
+// BigUint64Array once an handle above 2^53, a bigint, is enqueued
+export class HandleReleaseQueue
+{
+    static readonly DEFAULT_THRESHOLD = 256;
+    static readonly DEFAULT_INTERVAL = 1000;
+
+    #releaser: (handles: Float64Array | BigUint64Array, count: number) => void;
+    #handles: Float64Array | BigUint64Array;
+    #count: number = 0;
+    #interval: number;
+    #timer: ReturnType<typeof setTimeout> | null = null;
+    #flushCount: number = 0;
+    #lastFlushLatency: number = 0;
+    #totalFlushLatency: number = 0;
+
+    // The interval is expressed in milliseconds
+    constructor(releaser: (handles: Float64Array | BigUint64Array, count: number) => void,
+        threshold: number = HandleReleaseQueue.DEFAULT_THRESHOLD, interval: number = HandleReleaseQueue.DEFAULT_INTERVAL)
+    {
+        if (threshold < 1)
+            throw new Error(`The threshold must be positive`);
+
+        this.#releaser = releaser;
+        this.#handles = new Float64Array(threshold);
+        this.#interval = interval;
+    }
+
+    enqueue(handle: number | bigint): void
+    {
+        if (this.#handles instanceof BigUint64Array)
+        {
+            this.#handles[this.#count] = BigInt(handle);
+        }
+        else if (typeof handle === "bigint")
+        {
+            let handles = new BigUint64Array(this.#handles.length);
+            for (let i = 0; i < this.#count; i++)
+                handles[i] = BigInt(this.#handles[i]);
+
+            handles[this.#count] = handle;
+            this.#handles = handles;
+        }
+        else
+        {
+            this.#handles[this.#count] = handle;
+        }
+
+        this.#count++;
+        if (this.#count === this.#handles.length)
+        {
+            this.flush();
+        }
+        else if (this.#timer === null)
+        {
+            this.#timer = setTimeout(() => {
+                this.#timer = null;
+                this.flush();
+            }, this.#interval);
+
+            // Pending handles must not keep the process alive
+            (this.#timer as any).unref?.();
+        }
+    }
+
+    flush(): void
+    {
+        if (this.#timer !== null)
+        {
+            clearTimeout(this.#timer);
+            this.#timer = null;
+        }
+
+        if (this.#count === 0)
+            return;
+
+        // The buffer can be reused right away, since
+        // the handles are consumed synchronously
+        let count = this.#count;
+        this.#count = 0;
+        let start = performance.now();
+        this.#releaser(this.#handles, count);
+        let latency = performance.now() - start;
+        this.#flushCount++;
+        this.#lastFlushLatency = latency;
+        this.#totalFlushLatency += latency;
+    }
+
+    /** Number of handles waiting to be released */
+    get depth(): number
+    {
+        return this.#count;
+    }
+
+    get flushCount(): number
+    {
+        return this.#flushCount;
+    }
+
+    /** Duration of the last flush, in milliseconds */
+    get lastFlushLatency(): number
+    {
+        return this.#lastFlushLatency;
+    }
+
+    /** Overall time spent flushing, in milliseconds */
+    get totalFlushLatency(): number
+    {
+        return this.#totalFlushLatency;
+    }
+}
+""";
+
     const string FinalizableObject =
 """
 export class FinalizableObject extends ObjectTS
@@ -317,11 +440,14 @@ export class FinalizableObject extends ObjectTS
 export class HandledObjectBase extends FinalizableObject
 {
     #_handle : number;
+    #_handled : boolean;
+    #_handleRef : HandleRef | null = null;
 
     protected constructor(handle: number, handled: boolean)
     {
         super();
         this.#_handle = handle;
+        this.#_handled = handled;
         if (handled)
         {
             let finalizer = this.createFinalizer();
@@ -340,9 +466,23 @@ export class HandledObjectBase extends FinalizableObject
         return this.#_handle;
     }
 
+    // True if the handle is owned, and freed, by this object
+    get handled(): boolean
+    {
+        return this.#_handled;
+    }
+
     get handle(): HandleRef
     {
-        return new HandleRef(this, this.#_handle);
+        // The reference is created once, with the native pointer attached,
+        // so trampolines can read it without looking up properties
+        if (this.#_handleRef === null)
+        {
+            this.#_handleRef = new HandleRef(this, this.#_handle);
+            napi.WrapHandleRef(this.#_handleRef, this.#_handle);
+        }
+
+        return this.#_handleRef;
     }
 
     get managed(): boolean
@@ -385,6 +525,58 @@ export class HandledObject <BaseT extends HandledObject<BaseT>> extends HandledO
         return super.equals(other);
     }
 }
+""";
+
+    const string HandledObjectCache =
+"""
+// Optional weak identity map of wrappers, keyed by native handle. Looking up
+// an handle that is still wrapped by a live object returns the same wrapper,
+// instead of allocating a new one. Entries don't keep wrappers alive.
+// Only wrappers of handles owned elsewhere (eg. by a parent object) can be
+// cached: the owner must remove() the handle when it releases the native
+// object, since the address can be reused by a new one
+export class HandledObjectCache<T extends HandledObjectBase>
+{
+    #map: Map<number, WeakRef<T>>;
+    #registry: FinalizationRegistry<number>;
+
+    constructor()
+    {
+        this.#map = new Map<number, WeakRef<T>>();
+        this.#registry = new FinalizationRegistry<number>((handle: number) => {
+            // The handle may have been wrapped again in the meantime
+            let reference = this.#map.get(handle);
+            if (reference !== undefined && reference.deref() === undefined)
+                this.#map.delete(handle);
+        });
+    }
+
+    // Get the live wrapper of the handle, or null if there's none
+    get(handle: number): T | null
+    {
+        let reference = this.#map.get(handle);
+        if (reference === undefined)
+            return null;
+
+        return reference.deref() ?? null;
+    }
+
+    add(obj: T): void
+    {
+        if (obj.handled)
+            throw new Error(`Wrappers of owned handles can't be cached`);
+
+        let handle = obj.unsafeHandle;
+        this.#map.set(handle, new WeakRef<T>(obj));
+        this.#registry.register(obj, handle);
+    }
+
+    // Forget the wrapper of the handle, eg. when the handle is released explicitly
+    remove(handle: number): void
+    {
+        this.#map.delete(handle);
+    }
+}
 """;
 
     const string IDisposable =
@@ -32,6 +32,11 @@ let napi: any = napi_;
         foreach (var enm in Context.Enums)
             builder.Append(new TypeScriptEnumWriter(enm)).AppendLine();
 
+        builder.AppendLine("// Delegates");
+        builder.AppendLine();
+        foreach (var dlg in Context.Delegates)
+            builder.Append(new TypeScriptDelegateWriter(dlg)).AppendLine();
+
         builder.AppendLine("// Interfaces");
         builder.AppendLine();
         foreach (var iface in Context.Interfaces)
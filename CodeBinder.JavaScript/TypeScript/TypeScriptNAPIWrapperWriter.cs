@@ -1,4 +1,5 @@
 ﻿using CodeBinder.Attributes;
+using System.Linq;
 
 namespace CodeBinder.JavaScript.TypeScript;
 
@@ -95,6 +96,94 @@ const mod = { exports: {} };
 let napi = (mod.exports as any)({ConversionCSharpToTypeScript.CodeBinderNamespace});
 export default napi;
 """);
+
+        bool first = true;
+        foreach (var type in Context.StorageTypes.AllDeclarations)
+        {
+            foreach (var method in type.Members.OfType<MethodDeclarationSyntax>())
+            {
+                if (!method.IsNative(Context) || method.ShouldDiscard(Context)
+                    || !method.HasAttribute<AsyncAttribute>(Context))
+                {
+                    continue;
+                }
+
+                if (first)
+                {
+                    builder.AppendLine();
+                    builder.AppendLine("// Asynchronous variants of the [Async] native methods, which");
+                    builder.AppendLine("// run on the thread pool and resolve with the converted result");
+                    first = false;
+                }
+
+                appendAsyncMethod(builder, method);
+            }
+        }
+    }
+
+    void appendAsyncMethod(CodeBuilder builder, MethodDeclarationSyntax method)
+    {
+        var symbol = method.GetDeclaredSymbol<IMethodSymbol>(Context);
+        string name = $"{method.GetName()}Async";
+        builder.Append("export function").Space().Append(name).Append("(");
+        bool first = true;
+        foreach (var param in symbol.Parameters)
+        {
+            if (first)
+                first = false;
+            else
+                builder.Append(", ");
+
+            builder.Append(param.Name).Append(": ").Append(getNativeType(param.Type, false));
+        }
+
+        builder.Append("): Promise<").Append(getNativeType(symbol.ReturnType, true)).AppendLine(">");
+        builder.AppendLine("{");
+        builder.Append("    return napi.").Append(name).Append("(")
+            .Append(string.Join(", ", symbol.Parameters.Select((param) => param.Name))).AppendLine(");");
+        builder.AppendLine("}");
+        builder.AppendLine();
+    }
+
+    // TypeScript type of the values exchanged with the native trampolines
+    static string getNativeType(ITypeSymbol type, bool isReturn)
+    {
+        if (type.TypeKind == TypeKind.Enum)
+            return "number";
+
+        if (type.TypeKind == TypeKind.Array)
+        {
+            var arrayType = (IArrayTypeSymbol)type;
+            if (arrayType.ElementType.SpecialType == SpecialType.System_Boolean)
+                return "CodeBinder.BooleanArray | null";
+
+            return $"{type.WithNullableAnnotation(NullableAnnotation.NotAnnotated).GetTypeScriptType()} | null";
+        }
+
+        switch (type.GetFullName())
+        {
+            case "System.Void":
+                return "void";
+            case "System.Boolean":
+            case "CodeBinder.cbbool":
+                return "boolean";
+            case "CodeBinder.cboptbool":
+                return "boolean | null";
+            case "System.Int64":
+            case "System.UInt64":
+                return "bigint";
+            case "CodeBinder.cbstring":
+                return "string | null";
+            case "CodeBinder.cbstringarray":
+                return "string[] | null";
+            case "CodeBinder.cbbuffer":
+            case "CodeBinder.cbspan":
+                return isReturn ? "Uint8Array | null" : "ArrayBufferView | null";
+            case "System.Runtime.InteropServices.HandleRef":
+                return "CodeBinder.HandleRef";
+            default:
+                return "number";
+        }
     }
 
     void appendLoadLibrary(CodeBuilder builder, string libraryName)
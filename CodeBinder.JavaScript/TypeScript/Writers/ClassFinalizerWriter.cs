@@ -18,10 +18,24 @@ class ClassFinalizerWriter : CodeWriter
         Builder.AppendLine($"class {_finalizableType.Name}Finalizer extends HandledObjectFinalizer");
         using (Builder.Block())
         {
-            Builder.AppendLine("override freeHandle(handle: number): void");
-            using (Builder.Block())
+            if (_finalizer.Body!.TryGetBatchedReleaseMethod(_context, out var release))
             {
-                Builder.Append(_finalizer.Body!, _context, true).AppendLine();
+                // Handles are released in bulk through the batched entry point
+                Builder.AppendLine($"static releaseQueue = new HandleReleaseQueue((handles: Float64Array | BigUint64Array, count: number) => napi.{release.Name}Batch(handles, count));");
+                Builder.AppendLine();
+                Builder.AppendLine("override freeHandle(handle: number): void");
+                using (Builder.Block())
+                {
+                    Builder.AppendLine($"{_finalizableType.Name}Finalizer.releaseQueue.enqueue(handle);");
+                }
+            }
+            else
+            {
+                Builder.AppendLine("override freeHandle(handle: number): void");
+                using (Builder.Block())
+                {
+                    Builder.Append(_finalizer.Body!, _context, true).AppendLine();
+                }
             }
         }
     }
@@ -0,0 +1,36 @@
+﻿// SPDX-FileCopyrightText: (C) 2023 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: MIT
+
+namespace CodeBinder.JavaScript.TypeScript;
+
+/// <summary>
+/// Delegates are written as top level function types, since TypeScript
+/// doesn't allow types nested in classes
+/// </summary>
+class TypeScriptDelegateWriter : CodeWriter<TypeScriptDelegateContext>
+{
+    public TypeScriptDelegateWriter(TypeScriptDelegateContext dlg)
+        : base(dlg)
+    {
+    }
+
+    protected override void Write()
+    {
+        if (Item.Node.HasAccessibility(Accessibility.Public, Compilation))
+            Builder.Append("export").Space();
+
+        // e.g. export type ProgressCallback = (current: number, total: number, message: string) => void;
+        Builder.Append("type").Space().Append(Item.Node.Identifier.Text).Space().Append("=").Space();
+        var parameters = Builder.Parenthesized();
+        bool first = true;
+        foreach (var parameter in Item.Node.ParameterList.Parameters)
+        {
+            parameters.CommaSeparator(ref first).Append(parameter.Identifier.Text).Colon().Space()
+                .Append(parameter.Type!.GetTypeScriptType(Compilation));
+        }
+
+        parameters.Close().Space().Append("=>").Space().Append(Item.Node.ReturnType.GetTypeScriptType(Compilation)).EndOfStatement();
+    }
+
+    public TypeScriptCompilationContext Compilation => Item.Compilation;
+}
@@ -291,6 +291,12 @@ public static class NAOTMethodExtensions
             }
             case "CodeBinder.cbstring":
                 return "cbstring";
+            case "CodeBinder.cbbuffer":
+                return "cbbuffer";
+            case "CodeBinder.cbstringarray":
+                return "cbstringarray";
+            case "CodeBinder.cbspan":
+                return "cbspan";
             case "CodeBinder.cbbool":
                 return "cbbool";
             case "CodeBinder.cboptbool":
@@ -337,6 +343,12 @@ public static class NAOTMethodExtensions
                 return "cbbool*";
             case "CodeBinder.cboptbool":
                 return "cboptbool*";
+            case "CodeBinder.cbbuffer":
+                return "cbbuffer*";
+            case "CodeBinder.cbstringarray":
+                return "cbstringarray*";
+            case "CodeBinder.cbspan":
+                return "cbspan*";
             case "CodeBinder.cbstring":
                 return "cbstring*";
             case "System.Byte":
@@ -178,6 +178,58 @@ public sealed class ConstAttribute : CodeBinderAttribute
 {
 }
 
+/// <summary>
+/// Marshal array parameters of the native method without copying, where the target
+/// allows it (eg. JNI critical regions). Applied to a method it affects all array
+/// parameters. The native call must be short and must not call back into the runtime
+/// </summary>
+[AttributeUsage(AttributeTargets.Method | AttributeTargets.Parameter)]
+public sealed class CriticalArrayAttribute : CodeBinderAttribute
+{
+}
+
+/// <summary>
+/// Cache the strings returned by the native method, where the target converts
+/// them (eg. JNI). Useful for methods that return the same values repeatedly
+/// </summary>
+[AttributeUsage(AttributeTargets.Method)]
+public sealed class CachedStringAttribute : CodeBinderAttribute
+{
+}
+
+/// <summary>
+/// Mark the native method that releases handles (eg. the one called by
+/// FreeHandle). The targets with trampolines (eg. JNI, NAPI) generate a bulk
+/// entry point and release collected handles in batches through an
+/// HandleReleaseQueue. .NET finalizers keep calling FreeHandle directly,
+/// since a P/Invoke doesn't pay a JNI-like transition
+/// </summary>
+[AttributeUsage(AttributeTargets.Method)]
+public sealed class BatchedReleaseAttribute : CodeBinderAttribute
+{
+}
+
+/// <summary>
+/// Mark the native method that releases handles to run on the reclamation
+/// threads of the binding. The handover happens in the generated C functions,
+/// so it covers every target (eg. .NET finalizers, JNI, NAPI). The release
+/// function must be thread safe and must not call into the runtime
+/// </summary>
+[AttributeUsage(AttributeTargets.Method)]
+public sealed class BackgroundReleaseAttribute : CodeBinderAttribute
+{
+}
+
+/// <summary>
+/// Generate also an asynchronous variant of the native method, where the target
+/// supports it (eg. NAPI, as a Promise returning method run on the thread pool).
+/// The native function must be thread safe and must not call into the runtime
+/// </summary>
+[AttributeUsage(AttributeTargets.Method)]
+public sealed class AsyncAttribute : CodeBinderAttribute
+{
+}
+
 /// <summary>
 /// This attribute rapresents a stem that is used during the generation.
 ///
@@ -0,0 +1,240 @@
+﻿// SPDX-FileCopyrightText: (C) 2020 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: MIT
+using System.Reflection;
+using CodeBinder.Attributes;
+using System.Threading;
+
+namespace CodeBinder;
+
+/// <summary>
+/// Allocator used to marshal memory across the binding boundary, most
+/// notably owned cbstring data. On first use it binds the CB_AllocMemory,
+/// CB_FreeMemory and CB_FreeString entry points generated in the native library named by
+/// [assembly: NativeLibrary], so memory can be freed on either side of the
+/// boundary also when a custom native allocator is installed. If the
+/// library can't be found it uses the HGlobal heap, which matches the
+/// default native allocator in CBInterop.h
+/// </summary>
+public static unsafe class CBAllocator
+{
+    static delegate* unmanaged[Cdecl]<UIntPtr, IntPtr> _alloc;
+    static delegate* unmanaged[Cdecl]<IntPtr, void> _free;
+    static delegate* unmanaged[Cdecl]<cbstring*, void> _freeString;
+    static delegate* unmanaged[Cdecl]<UIntPtr, IntPtr> _nativeAlloc;
+    static delegate* unmanaged[Cdecl]<IntPtr, void> _nativeFree;
+    static delegate* unmanaged[Cdecl]<void> _setReclaimerFinalizerThread;
+    static readonly object _bindLock = new object();
+    static volatile bool _bound;
+    static bool _customAllocator;
+    static long _allocCount;
+    static long _freeCount;
+    static long _allocBytes;
+    static long _failedCount;
+
+    /// <summary>
+    /// Bind the allocator entry points of an already loaded native library.
+    /// Use it when the library is loaded with a custom DllImport resolver
+    /// and can't be found by the automatic binding. It must be called
+    /// before any string is marshalled
+    /// </summary>
+    public static void BindNativeLibrary(IntPtr handle)
+    {
+        if (handle == IntPtr.Zero)
+            throw new ArgumentNullException(nameof(handle));
+
+        lock (_bindLock)
+        {
+            if (!tryBind(handle))
+                throw new EntryPointNotFoundException("The library doesn't export the CodeBinder allocator entry points");
+
+            _bound = true;
+        }
+
+        ResetStats();
+    }
+
+    /// <summary>
+    /// Route allocations through custom allocation functions instead of
+    /// the bound ones. The functions must use the same heap as the
+    /// native library allocator. It must be called before any string is marshalled
+    /// </summary>
+    public static void SetNativeAllocator(IntPtr allocMemory, IntPtr freeMemory)
+    {
+        if (allocMemory == IntPtr.Zero || freeMemory == IntPtr.Zero)
+            throw new ArgumentNullException(allocMemory == IntPtr.Zero ? nameof(allocMemory) : nameof(freeMemory));
+
+        lock (_bindLock)
+        {
+            _alloc = (delegate* unmanaged[Cdecl]<UIntPtr, IntPtr>)allocMemory;
+            _free = (delegate* unmanaged[Cdecl]<IntPtr, void>)freeMemory;
+            _customAllocator = true;
+        }
+
+        ResetStats();
+    }
+
+    /// <summary>
+    /// Drop the custom allocation functions and go back to the CB_AllocMemory
+    /// and CB_FreeMemory entry points of the native library, or the HGlobal
+    /// heap if the library can't be found. It must be called before any
+    /// string is marshalled
+    /// </summary>
+    public static void ResetAllocator()
+    {
+        lock (_bindLock)
+        {
+            _alloc = _nativeAlloc;
+            _free = _nativeFree;
+            _customAllocator = false;
+        }
+
+        ResetStats();
+    }
+
+    public static CBAllocatorStats GetStats()
+    {
+        return new CBAllocatorStats(Interlocked.Read(ref _allocCount), Interlocked.Read(ref _freeCount),
+            Interlocked.Read(ref _allocBytes), Interlocked.Read(ref _failedCount));
+    }
+
+    public static void ResetStats()
+    {
+        Interlocked.Exchange(ref _allocCount, 0);
+        Interlocked.Exchange(ref _freeCount, 0);
+        Interlocked.Exchange(ref _allocBytes, 0);
+        Interlocked.Exchange(ref _failedCount, 0);
+    }
+
+    internal static IntPtr AllocMemory(int size)
+    {
+        ensureBound();
+        IntPtr ret;
+        if (_alloc == null)
+        {
+            ret = Marshal.AllocHGlobal(size);
+        }
+        else
+        {
+            ret = _alloc(new UIntPtr((uint)size));
+            if (ret == IntPtr.Zero)
+            {
+                Interlocked.Increment(ref _failedCount);
+                throw new OutOfMemoryException();
+            }
+        }
+
+        Interlocked.Increment(ref _allocCount);
+        Interlocked.Add(ref _allocBytes, size);
+        return ret;
+    }
+
+    internal static void FreeString(cbstring* str)
+    {
+        ensureBound();
+        if (_freeString == null)
+            throw new InvalidOperationException("The native library must be bound to release adopted or shared strings");
+
+        _freeString(str);
+    }
+
+    /// <summary>
+    /// Mark the current thread as a finalizer thread, so releasing
+    /// [BackgroundRelease] handles never stalls it. Libraries
+    /// without the entry point are ignored
+    /// </summary>
+    internal static void SetReclaimerFinalizerThread()
+    {
+        ensureBound();
+        if (_setReclaimerFinalizerThread != null)
+            _setReclaimerFinalizerThread();
+    }
+
+    internal static void FreeMemory(IntPtr ptr)
+    {
+        if (ptr == IntPtr.Zero)
+            return;
+
+        ensureBound();
+        Interlocked.Increment(ref _freeCount);
+        if (_free == null)
+            Marshal.FreeHGlobal(ptr);
+        else
+            _free(ptr);
+    }
+
+    static void ensureBound()
+    {
+        if (_bound)
+            return;
+
+        lock (_bindLock)
+        {
+            if (_bound)
+                return;
+
+            try
+            {
+                foreach (var assembly in AppDomain.CurrentDomain.GetAssemblies())
+                {
+                    var attribute = assembly.GetCustomAttribute<NativeLibraryAttribute>();
+                    if (attribute != null && NativeExports.TryGetLibrary(attribute.Name, assembly, out var handle)
+                        && tryBind(handle))
+                    {
+                        break;
+                    }
+                }
+            }
+            finally
+            {
+                // Don't retry: switching allocator after the first
+                // allocation would free memory with the wrong heap
+                _bound = true;
+            }
+        }
+    }
+
+    static bool tryBind(IntPtr handle)
+    {
+        if (!NativeExports.TryGetExport(handle, "CB_AllocMemory", out var alloc)
+            || !NativeExports.TryGetExport(handle, "CB_FreeMemory", out var free)
+            || !NativeExports.TryGetExport(handle, "CB_FreeString", out var freeString))
+        {
+            return false;
+        }
+
+        _nativeAlloc = (delegate* unmanaged[Cdecl]<UIntPtr, IntPtr>)alloc;
+        _nativeFree = (delegate* unmanaged[Cdecl]<IntPtr, void>)free;
+        if (!_customAllocator)
+        {
+            _alloc = _nativeAlloc;
+            _free = _nativeFree;
+        }
+
+        _freeString = (delegate* unmanaged[Cdecl]<cbstring*, void>)freeString;
+
+        // Optional, as it's exported only by recent libraries
+        if (NativeExports.TryGetExport(handle, "CB_SetReclaimerFinalizerThread", out var setFinalizerThread))
+            _setReclaimerFinalizerThread = (delegate* unmanaged[Cdecl]<void>)setFinalizerThread;
+
+        return true;
+    }
+}
+
+public readonly struct CBAllocatorStats
+{
+    public CBAllocatorStats(long allocCount, long freeCount, long allocBytes, long failedCount)
+    {
+        AllocCount = allocCount;
+        FreeCount = freeCount;
+        AllocBytes = allocBytes;
+        FailedCount = failedCount;
+    }
+
+    public long AllocCount { get; }
+
+    public long FreeCount { get; }
+
+    public long AllocBytes { get; }
+
+    public long FailedCount { get; }
+}
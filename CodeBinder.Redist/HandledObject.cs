@@ -51,6 +51,9 @@ public class HandledObject<BaseT> : HandledObjectBase
 
 public class HandledObjectBase : FinalizableObject
 {
+    [ThreadStatic]
+    static bool _finalizerThread;
+
     IntPtr _handle;
     bool _handled;
 
@@ -62,8 +65,16 @@ public class HandledObjectBase : FinalizableObject
 
     ~HandledObjectBase()
     {
-        if (_handled)
-            FreeHandle(_handle);
+        if (!_handled)
+            return;
+
+        if (!_finalizerThread)
+        {
+            CBAllocator.SetReclaimerFinalizerThread();
+            _finalizerThread = true;
+        }
+
+        FreeHandle(_handle);
     }
 
     protected virtual void FreeHandle(IntPtr handle)
@@ -90,6 +101,14 @@ public class HandledObjectBase : FinalizableObject
         get { return _handle; }
     }
 
+    /// <summary>
+    /// True if the handle is owned, and freed, by this object
+    /// </summary>
+    internal bool IsHandled
+    {
+        get { return _handled; }
+    }
+
     public override bool Equals(object? obj)
     {
         return Equals(obj as HandledObjectBase);
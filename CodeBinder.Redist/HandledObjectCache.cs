@@ -0,0 +1,84 @@
+﻿// SPDX-FileCopyrightText: (C) 2020 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: MIT
+using System.Collections.Generic;
+
+namespace CodeBinder;
+
+/// <summary>
+/// Optional weak identity map of wrappers, keyed by native handle. Looking up
+/// an handle that is still wrapped by a live object returns the same wrapper,
+/// instead of allocating a new one. Entries don't keep wrappers alive.
+/// Only wrappers of handles owned elsewhere (eg. by a parent object) can be
+/// cached: the owner must Remove() the handle when it releases the native
+/// object, since the address can be reused by a new one
+/// </summary>
+public sealed class HandledObjectCache<T>
+    where T : HandledObjectBase
+{
+    const int MinPurgeThreshold = 64;
+
+    readonly Dictionary<IntPtr, WeakReference<T>> _map;
+    int _purgeThreshold;
+
+    public HandledObjectCache()
+    {
+        _map = new Dictionary<IntPtr, WeakReference<T>>();
+        _purgeThreshold = MinPurgeThreshold;
+    }
+
+    /// <summary>
+    /// Get the live wrapper of the handle, or null if there's none
+    /// </summary>
+    public T? Get(IntPtr handle)
+    {
+        lock (_map)
+        {
+            if (_map.TryGetValue(handle, out var reference) && reference.TryGetTarget(out var obj))
+                return obj;
+
+            return null;
+        }
+    }
+
+    public void Add(T obj)
+    {
+        if (obj.IsHandled)
+            throw new ArgumentException("Wrappers of owned handles can't be cached", nameof(obj));
+
+        lock (_map)
+        {
+            // Drop the entries of collected wrappers, amortized
+            // by doubling the threshold on the surviving entries
+            if (_map.Count >= _purgeThreshold)
+                purge();
+
+            _map[obj.UnsafeHandle] = new WeakReference<T>(obj);
+        }
+    }
+
+    /// <summary>
+    /// Forget the wrapper of the handle, eg. when the handle is released explicitly
+    /// </summary>
+    public void Remove(IntPtr handle)
+    {
+        lock (_map)
+        {
+            _map.Remove(handle);
+        }
+    }
+
+    void purge()
+    {
+        var collected = new List<IntPtr>();
+        foreach (var pair in _map)
+        {
+            if (!pair.Value.TryGetTarget(out _))
+                collected.Add(pair.Key);
+        }
+
+        foreach (var handle in collected)
+            _map.Remove(handle);
+
+        _purgeThreshold = Math.Max(MinPurgeThreshold, _map.Count * 2);
+    }
+}
@@ -0,0 +1,121 @@
+﻿// SPDX-FileCopyrightText: (C) 2020 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: MIT
+using System.IO;
+using System.Reflection;
+
+namespace CodeBinder;
+
+/// <summary>
+/// Resolve exports of the native library. System.Runtime.InteropServices.NativeLibrary
+/// is not part of the targeted frameworks, so it's reached by reflection when
+/// available, falling back to kernel32 on .NET Framework
+/// </summary>
+static class NativeExports
+{
+    delegate bool TryLoadAssemblyFunc(string libraryName, Assembly assembly, DllImportSearchPath? searchPath, out IntPtr handle);
+    delegate bool TryLoadPathFunc(string libraryPath, out IntPtr handle);
+    delegate bool TryGetExportFunc(IntPtr handle, string name, out IntPtr address);
+
+    static readonly TryLoadAssemblyFunc? _tryLoadAssembly;
+    static readonly TryLoadPathFunc? _tryLoadPath;
+    static readonly TryGetExportFunc? _tryGetExport;
+
+    static NativeExports()
+    {
+        var type = Type.GetType("System.Runtime.InteropServices.NativeLibrary", false);
+        if (type == null)
+            return;
+
+        _tryLoadAssembly = createDelegate<TryLoadAssemblyFunc>(type, "TryLoad",
+            typeof(string), typeof(Assembly), typeof(DllImportSearchPath?), typeof(IntPtr).MakeByRefType());
+        _tryLoadPath = createDelegate<TryLoadPathFunc>(type, "TryLoad",
+            typeof(string), typeof(IntPtr).MakeByRefType());
+        _tryGetExport = createDelegate<TryGetExportFunc>(type, "TryGetExport",
+            typeof(IntPtr), typeof(string), typeof(IntPtr).MakeByRefType());
+    }
+
+    /// <summary>
+    /// Get the handle of the native library bound by the given assembly.
+    /// The library is first searched with the same rules of DllImport,
+    /// then among the modules already loaded in the process, which
+    /// covers libraries loaded by custom resolvers
+    /// </summary>
+    public static bool TryGetLibrary(string libraryName, Assembly assembly, out IntPtr handle)
+    {
+        if (_tryLoadAssembly != null && _tryLoadAssembly(libraryName, assembly, null, out handle))
+            return true;
+
+        if (Environment.OSVersion.Platform == PlatformID.Win32NT && _tryLoadPath == null)
+        {
+            // .NET Framework
+            handle = GetModuleHandle(libraryName);
+            if (handle == IntPtr.Zero)
+                handle = LoadLibrary(libraryName);
+
+            return handle != IntPtr.Zero;
+        }
+
+        handle = IntPtr.Zero;
+        if (_tryLoadPath == null)
+            return false;
+
+        string? path = findLoadedModule(libraryName);
+        return path != null && _tryLoadPath(path, out handle);
+    }
+
+    public static bool TryGetExport(IntPtr handle, string name, out IntPtr address)
+    {
+        if (_tryGetExport != null)
+            return _tryGetExport(handle, name, out address);
+
+        if (Environment.OSVersion.Platform == PlatformID.Win32NT)
+        {
+            address = GetProcAddress(handle, name);
+            return address != IntPtr.Zero;
+        }
+
+        address = IntPtr.Zero;
+        return false;
+    }
+
+    static string? findLoadedModule(string libraryName)
+    {
+        try
+        {
+            foreach (ProcessModule module in Process.GetCurrentProcess().Modules)
+            {
+                string filename = Path.GetFileName(module.FileName);
+                if (filename.StartsWith(libraryName + ".", StringComparison.Ordinal)
+                    || filename.StartsWith("lib" + libraryName + ".", StringComparison.Ordinal))
+                {
+                    return module.FileName;
+                }
+            }
+        }
+        catch (Exception)
+        {
+            // Enumerating modules may be not permitted
+        }
+
+        return null;
+    }
+
+    static TDelegate? createDelegate<TDelegate>(Type type, string name, params Type[] parameters)
+        where TDelegate : Delegate
+    {
+        var method = type.GetMethod(name, BindingFlags.Public | BindingFlags.Static, null, parameters, null);
+        if (method == null)
+            return null;
+
+        return (TDelegate)Delegate.CreateDelegate(typeof(TDelegate), method);
+    }
+
+    [DllImport("kernel32", CharSet = CharSet.Unicode)]
+    static extern IntPtr GetModuleHandle(string moduleName);
+
+    [DllImport("kernel32", CharSet = CharSet.Unicode)]
+    static extern IntPtr LoadLibrary(string fileName);
+
+    [DllImport("kernel32", CharSet = CharSet.Ansi)]
+    static extern IntPtr GetProcAddress(IntPtr module, string procName);
+}
@@ -0,0 +1,132 @@
+﻿// SPDX-FileCopyrightText: (C) 2023 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: MIT
+namespace CodeBinder;
+
+/// <summary>
+/// Element kinds of a cbbuffer, as defined in CBBaseTypes.h
+/// </summary>
+public enum CBElementKind
+{
+    UInt8 = 0,
+    Int8,
+    UInt16,
+    Int16,
+    UInt32,
+    Int32,
+    UInt64,
+    Int64,
+    Float,
+    Double,
+}
+
+/// <summary>
+/// A structure that can be used to return a variable length native
+/// buffer from DllImport methods in a single call
+/// </summary>
+#pragma warning disable IDE1006 // Naming Styles
+[StructLayout(LayoutKind.Sequential)]
+public unsafe struct cbbuffer
+#pragma warning restore IDE1006 // Naming Styles
+{
+    const uint OwnsDataFlags32 = 1u << 31;
+    const ulong OwnsDataFlags64 = 1ul << 63;
+
+    IntPtr m_data;
+    UIntPtr m_length;
+    int m_kind;
+
+    public CBElementKind Kind
+    {
+        get { return (CBElementKind)m_kind; }
+    }
+
+    public static implicit operator byte[]?(cbbuffer buffer)
+    {
+        return buffer.ToArray<byte>();
+    }
+
+    /// <summary>
+    /// Copy the buffer to a managed array, releasing the native
+    /// data if owned by the receiver
+    /// </summary>
+    public T[]? ToArray<T>() where T : unmanaged
+    {
+        if (m_data == IntPtr.Zero)
+            return null;
+
+        bool ownsdata;
+        ulong length;
+        // First bit of length tells if receiver owns the buffer
+        if (sizeof(UIntPtr) == 8)
+        {
+            ulong l = m_length.ToUInt64();
+            ownsdata = (l & OwnsDataFlags64) != 0;
+            length = l & ~OwnsDataFlags64;
+        }
+        else
+        {
+            uint l = m_length.ToUInt32();
+            ownsdata = (l & OwnsDataFlags32) != 0;
+            length = l & ~OwnsDataFlags32;
+        }
+
+        try
+        {
+            // Byte arrays can view any element kind
+            if (typeof(T) != typeof(byte) && sizeof(T) != getElementSize(Kind))
+                throw new InvalidCastException($"Can't convert buffer of kind {Kind} to {typeof(T).Name}[]");
+
+            // Managed arrays can't be indexed beyond int.MaxValue
+            ulong size = checked(length * (ulong)getElementSize(Kind));
+            int count = checked((int)(size / (ulong)sizeof(T)));
+            var ret = new T[count];
+            fixed (T* pRet = ret)
+                copyMemory((byte*)pRet, (byte*)m_data, size);
+
+            return ret;
+        }
+        finally
+        {
+            if (ownsdata)
+                CBAllocator.FreeMemory(m_data);
+        }
+    }
+
+    static void copyMemory(byte* dst, byte* src, ulong size)
+    {
+#if NET452
+        // Buffer.MemoryCopy is not available: copy by words
+        ulong i = 0;
+        for (; i + 8 <= size; i += 8)
+            *(ulong*)(dst + i) = *(ulong*)(src + i);
+
+        for (; i < size; i++)
+            dst[i] = src[i];
+#else
+        Buffer.MemoryCopy(src, dst, size, size);
+#endif
+    }
+
+    static int getElementSize(CBElementKind kind)
+    {
+        switch (kind)
+        {
+            case CBElementKind.UInt8:
+            case CBElementKind.Int8:
+                return 1;
+            case CBElementKind.UInt16:
+            case CBElementKind.Int16:
+                return 2;
+            case CBElementKind.UInt32:
+            case CBElementKind.Int32:
+            case CBElementKind.Float:
+                return 4;
+            case CBElementKind.UInt64:
+            case CBElementKind.Int64:
+            case CBElementKind.Double:
+                return 8;
+            default:
+                throw new NotSupportedException($"Unsupported element kind {kind}");
+        }
+    }
+}
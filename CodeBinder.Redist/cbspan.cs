@@ -0,0 +1,71 @@
+﻿// SPDX-FileCopyrightText: (C) 2024 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: MIT
+namespace CodeBinder;
+
+/// <summary>
+/// A byte view of native memory. Backends that support it share the
+/// memory without copying, eg. Java maps it to a direct ByteBuffer
+/// </summary>
+#pragma warning disable IDE1006 // Naming Styles
+[StructLayout(LayoutKind.Sequential)]
+public unsafe struct cbspan
+#pragma warning restore IDE1006 // Naming Styles
+{
+    const uint OwnsDataFlags32 = 1u << 31;
+    const ulong OwnsDataFlags64 = 1ul << 63;
+
+    IntPtr m_data;
+    UIntPtr m_length;
+
+    /// <summary>
+    /// Create a non owning view of the given memory
+    /// </summary>
+    public cbspan(IntPtr data, int length)
+    {
+        if (length < 0)
+            throw new ArgumentOutOfRangeException(nameof(length));
+
+        m_data = data;
+        m_length = new UIntPtr((uint)length);
+    }
+
+    public IntPtr Data
+    {
+        get { return m_data; }
+    }
+
+    public int Length
+    {
+        get
+        {
+            // First bit of length tells if receiver owns the memory
+            if (sizeof(UIntPtr) == 8)
+                return (int)(m_length.ToUInt64() & ~OwnsDataFlags64);
+            else
+                return (int)(m_length.ToUInt32() & ~OwnsDataFlags32);
+        }
+    }
+
+    public bool OwnsData
+    {
+        get
+        {
+            if (sizeof(UIntPtr) == 8)
+                return (m_length.ToUInt64() & OwnsDataFlags64) != 0;
+            else
+                return (m_length.ToUInt32() & OwnsDataFlags32) != 0;
+        }
+    }
+
+    /// <summary>
+    /// Release the native memory, if owned by the receiver
+    /// </summary>
+    public void Free()
+    {
+        if (OwnsData)
+            CBAllocator.FreeMemory(m_data);
+
+        m_data = IntPtr.Zero;
+        m_length = UIntPtr.Zero;
+    }
+}
@@ -1,5 +1,6 @@
 ﻿// SPDX-FileCopyrightText: (C) 2020 Francesco Pretto <ceztko@gmail.com>
 // SPDX-License-Identifier: MIT
+using System.Collections.Concurrent;
 using System.Text;
 
 namespace CodeBinder;
@@ -11,6 +12,18 @@ public unsafe struct cbstring
 {
     const uint OwnsDataFlags32 = 1u << 31;
     const ulong OwnsDataFlags64 = 1ul << 63;
+    // Adopted native buffers must be released by native code
+    const uint ExternalFlags32 = 1u << 29;
+    const ulong ExternalFlags64 = 1ul << 61;
+    // Shared strings not owned by the receiver are interned
+    const uint SharedFlags32 = 1u << 28;
+    const ulong SharedFlags64 = 1ul << 60;
+    // Also strip the native scratch arena flag
+    const uint FlagsMask32 = OwnsDataFlags32 | ExternalFlags32 | SharedFlags32 | (1u << 30);
+    const ulong FlagsMask64 = OwnsDataFlags64 | ExternalFlags64 | SharedFlags64 | (1ul << 62);
+
+    // Interned native strings are immortal, so they are cached by data pointer
+    static ConcurrentDictionary<IntPtr, string> _internedStrings = new ConcurrentDictionary<IntPtr, string>();
 
     IntPtr m_data;
     UIntPtr m_length;
@@ -21,24 +34,48 @@ public unsafe struct cbstring
             return null;
 
         bool ownsdata;
+        bool external;
+        bool shared;
         int length;
         // First bit of length tells if receiver owns string
         if (sizeof(UIntPtr) == 8)
         {
             ulong l = cbstr.m_length.ToUInt64();
             ownsdata = (l & OwnsDataFlags64) != 0;
-            length = (int)(l & ~OwnsDataFlags64);
+            external = (l & ExternalFlags64) != 0;
+            shared = (l & SharedFlags64) != 0;
+            length = (int)(l & ~FlagsMask64);
         }
         else
         {
             uint l = cbstr.m_length.ToUInt32();
             ownsdata = (l & OwnsDataFlags32) != 0;
-            length = (int)(l & ~OwnsDataFlags32);
+            external = (l & ExternalFlags32) != 0;
+            shared = (l & SharedFlags32) != 0;
+            length = (int)(l & ~FlagsMask32);
         }
 
-        var ret = MarshalNativeUtf8ToManagedString(cbstr.m_data, length);
+        string? ret;
+        if (shared && !ownsdata)
+        {
+            if (!_internedStrings.TryGetValue(cbstr.m_data, out ret))
+            {
+                ret = MarshalNativeUtf8ToManagedString(cbstr.m_data, length)!;
+                _internedStrings.TryAdd(cbstr.m_data, ret);
+            }
+
+            return ret;
+        }
+
+        ret = MarshalNativeUtf8ToManagedString(cbstr.m_data, length);
         if (ownsdata)
-            Marshal.FreeHGlobal(cbstr.m_data);
+        {
+            // Adopted and reference counted strings are released by native code
+            if (external || shared)
+                CBAllocator.FreeString(&cbstr);
+            else
+                CBAllocator.FreeMemory(cbstr.m_data);
+        }
 
         return ret;
     }
@@ -65,7 +102,7 @@ public unsafe struct cbstring
         {
             int utf8Len = Encoding.UTF8.GetByteCount(pInput, input.Length);
             // Allocate also the space of the termination character
-            var pResult = (byte*)Marshal.AllocHGlobal(utf8Len + 1);
+            var pResult = (byte*)CBAllocator.AllocMemory(utf8Len + 1);
             Encoding.UTF8.GetBytes(pInput, input.Length, pResult, utf8Len);
             pResult[utf8Len] = 0; // Null character
             data = (IntPtr)pResult;
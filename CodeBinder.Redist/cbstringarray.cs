@@ -0,0 +1,62 @@
+﻿// SPDX-FileCopyrightText: (C) 2023 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: MIT
+namespace CodeBinder;
+
+/// <summary>
+/// A structure that can be used to return an array of strings from
+/// DllImport methods. Strings are packed in a single native block
+/// </summary>
+#pragma warning disable IDE1006 // Naming Styles
+[StructLayout(LayoutKind.Sequential)]
+public unsafe struct cbstringarray
+#pragma warning restore IDE1006 // Naming Styles
+{
+    const uint OwnsDataFlags32 = 1u << 31;
+    const ulong OwnsDataFlags64 = 1ul << 63;
+
+    IntPtr m_data;
+    UIntPtr m_count;
+
+    public static implicit operator string[]?(cbstringarray arr)
+    {
+        if (arr.m_data == IntPtr.Zero)
+            return null;
+
+        bool ownsdata;
+        int count;
+        // First bit of count tells if receiver owns the array
+        if (sizeof(UIntPtr) == 8)
+        {
+            ulong c = arr.m_count.ToUInt64();
+            ownsdata = (c & OwnsDataFlags64) != 0;
+            count = (int)(c & ~OwnsDataFlags64);
+        }
+        else
+        {
+            uint c = arr.m_count.ToUInt32();
+            ownsdata = (c & OwnsDataFlags32) != 0;
+            count = (int)(c & ~OwnsDataFlags32);
+        }
+
+        try
+        {
+            // The offsets table is followed by the null terminated strings
+            var offsets = (UIntPtr*)arr.m_data;
+            var chars = (byte*)(offsets + count + 1);
+            var ret = new string[count];
+            for (int i = 0; i < count; i++)
+            {
+                int offset = (int)offsets[i].ToUInt64();
+                int length = (int)offsets[i + 1].ToUInt64() - offset - 1;
+                ret[i] = cbstring.MarshalNativeUtf8ToManagedString((IntPtr)(chars + offset), length)!;
+            }
+
+            return ret;
+        }
+        finally
+        {
+            if (ownsdata)
+                CBAllocator.FreeMemory(arr.m_data);
+        }
+    }
+}
@@ -0,0 +1,95 @@
+﻿// SPDX-FileCopyrightText: (C) 2020 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: MIT-0
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Reflection;
+using System.Runtime.InteropServices;
+using System.Text.Json;
+using BenchmarkLibrary;
+using CodeBinder;
+
+namespace BenchmarkRunner;
+
+/// <summary>
+/// P/Invoke interop micro-benchmarks, which also cover the Redist
+/// cbstring, cbbuffer and cbstringarray conversions.
+/// Usage: BenchmarkRunner &lt;path to native library&gt; [iterations]
+/// </summary>
+static class Program
+{
+    static readonly List<Dictionary<string, object>> _results = new List<Dictionary<string, object>>();
+    // Sink for returned values, so calls can't be optimized away
+    static long _sink;
+
+    static void Main(string[] args)
+    {
+        var libpath = Path.GetFullPath(args[0]);
+        int iterations = args.Length > 1 ? int.Parse(args[1], CultureInfo.InvariantCulture) : 1000000;
+        var handle = NativeLibrary.Load(libpath);
+        NativeLibrary.SetDllImportResolver(typeof(Benchmark).Assembly,
+            (name, assembly, path) => name == "BenchmarkLibrary" ? handle : IntPtr.Zero);
+
+        // The library is loaded by path, so bind the native allocator explicitly
+        CBAllocator.BindNativeLibrary(handle);
+
+        string str16 = new string('a', 16);
+        string str1024 = new string('a', 1024);
+        var bytes16 = new byte[16];
+        var bytes4096 = new byte[4096];
+        var ints16 = new int[16];
+        var ints4096 = new int[4096];
+        int box = 0;
+
+        run("noop", "call", 0, iterations, () => Benchmark.Noop());
+        run("pass_int", "call", 0, iterations, () => _sink += Benchmark.PassInt(42));
+        run("pass_string", "string_in", 16, iterations, () => _sink += Benchmark.PassString(str16));
+        run("pass_string", "string_in", 1024, iterations, () => _sink += Benchmark.PassString(str1024));
+        run("return_string", "string_out", 16, iterations, () => _sink += Benchmark.ReturnString(16)!.Length);
+        run("return_string", "string_out", 1024, iterations, () => _sink += Benchmark.ReturnString(1024)!.Length);
+        run("read_array", "array_in", 16, iterations, () => _sink += Benchmark.ReadArray(bytes16));
+        run("read_array", "array_in", 4096, iterations, () => _sink += Benchmark.ReadArray(bytes4096));
+        run("fill_array", "array_out", 16, iterations, () => Benchmark.FillArray(ints16));
+        run("fill_array", "array_out", 4096, iterations, () => Benchmark.FillArray(ints4096));
+        run("increment_box", "box_inout", 0, iterations, () => Benchmark.IncrementBox(ref box));
+        run("return_buffer", "buffer_out", 16, iterations, () => _sink += Benchmark.ReturnBuffer(16)!.Length);
+        run("return_buffer", "buffer_out", 4096, iterations / 10, () => _sink += Benchmark.ReturnBuffer(4096)!.Length);
+        run("return_string_array", "string_array_out", 16, iterations / 10, () => _sink += Benchmark.ReturnStringArray(16)!.Length);
+
+        var report = new Dictionary<string, object>
+        {
+            ["backend"] = "PInvoke",
+            ["runtime"] = RuntimeInformation.FrameworkDescription,
+            ["platform"] = RuntimeInformation.RuntimeIdentifier,
+            ["results"] = _results,
+        };
+        Console.WriteLine(JsonSerializer.Serialize(report, new JsonSerializerOptions { WriteIndented = true }));
+        if (_sink == 0)
+            Console.Error.WriteLine("Unexpected sink value");
+    }
+
+    static void run(string name, string primitive, int size, int iterations, Action body)
+    {
+        // Warm up, to let tiered compilation settle
+        int warmup = Math.Max(1, iterations / 10);
+        for (int i = 0; i < warmup; i++)
+            body();
+
+        var watch = Stopwatch.StartNew();
+        for (int i = 0; i < iterations; i++)
+            body();
+
+        watch.Stop();
+        double elapsedNs = watch.ElapsedTicks * (1_000_000_000.0 / Stopwatch.Frequency);
+        _results.Add(new Dictionary<string, object>
+        {
+            ["name"] = name,
+            ["primitive"] = primitive,
+            ["size"] = size,
+            ["iterations"] = iterations,
+            ["ns_per_call"] = elapsedNs / iterations,
+        });
+    }
+}
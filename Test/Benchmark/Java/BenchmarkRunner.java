@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: (C) 2020 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: MIT-0
+package BenchmarkLibrary;
+
+import java.util.*;
+import CodeBinder.*;
+
+// JNI interop micro-benchmarks, calling the generated Java wrappers.
+// Usage: java BenchmarkLibrary.BenchmarkRunner <path to JNI library> [iterations]
+public class BenchmarkRunner
+{
+    interface Body
+    {
+        void run();
+    }
+
+    static final StringBuilder results = new StringBuilder();
+    // Sink for returned values, so calls can't be optimized away
+    static long sink;
+
+    static void run(String name, String primitive, int size, int iterations, Body body)
+    {
+        // Warm up, to let the JIT compile the loop
+        int warmup = Math.max(1, iterations / 10);
+        for (int i = 0; i < warmup; i++)
+            body.run();
+
+        long start = System.nanoTime();
+        for (int i = 0; i < iterations; i++)
+            body.run();
+
+        long elapsed = System.nanoTime() - start;
+        if (results.length() != 0)
+            results.append(",\n");
+
+        results.append(String.format(Locale.ROOT,
+            "    { \"name\": \"%s\", \"primitive\": \"%s\", \"size\": %d, \"iterations\": %d, \"ns_per_call\": %.3f }",
+            name, primitive, size, iterations, (double)elapsed / iterations));
+    }
+
+    static String repeat(char c, int count)
+    {
+        char[] chars = new char[count];
+        Arrays.fill(chars, c);
+        return new String(chars);
+    }
+
+    public static void main(String[] args)
+    {
+        System.load(new java.io.File(args[0]).getAbsolutePath());
+        int iterations = args.length > 1 ? Integer.parseInt(args[1]) : 1000000;
+
+        String str16 = repeat('a', 16);
+        String str1024 = repeat('a', 1024);
+        byte[] bytes16 = new byte[16];
+        byte[] bytes4096 = new byte[4096];
+        int[] ints16 = new int[16];
+        int[] ints4096 = new int[4096];
+        IntegerBox box = new IntegerBox(0);
+
+        run("noop", "call", 0, iterations, () -> Benchmark.noop());
+        run("pass_int", "call", 0, iterations, () -> sink += Benchmark.passInt(42));
+        run("pass_string", "string_in", 16, iterations, () -> sink += Benchmark.passString(str16));
+        run("pass_string", "string_in", 1024, iterations, () -> sink += Benchmark.passString(str1024));
+        run("return_string", "string_out", 16, iterations, () -> sink += Benchmark.returnString(16).length());
+        run("return_string", "string_out", 1024, iterations, () -> sink += Benchmark.returnString(1024).length());
+        run("return_string_cached", "string_out", 16, iterations, () -> sink += Benchmark.returnStringCached(16).length());
+        run("read_array", "array_in", 16, iterations, () -> sink += Benchmark.readArray(bytes16));
+        run("read_array", "array_in", 4096, iterations, () -> sink += Benchmark.readArray(bytes4096));
+        run("read_array_critical", "array_in", 16, iterations, () -> sink += Benchmark.readArrayCritical(bytes16));
+        run("read_array_critical", "array_in", 4096, iterations, () -> sink += Benchmark.readArrayCritical(bytes4096));
+        run("fill_array", "array_out", 16, iterations, () -> Benchmark.fillArray(ints16));
+        run("fill_array", "array_out", 4096, iterations, () -> Benchmark.fillArray(ints4096));
+        run("increment_box", "box_inout", 0, iterations, () -> Benchmark.BBIncrementBox(box));
+        run("return_buffer", "buffer_out", 16, iterations, () -> sink += Benchmark.returnBuffer(16).length);
+        run("return_buffer", "buffer_out", 4096, iterations / 10, () -> sink += Benchmark.returnBuffer(4096).length);
+        run("return_string_array", "string_array_out", 16, iterations / 10, () -> sink += Benchmark.returnStringArray(16).length);
+
+        System.out.println("{");
+        System.out.println("  \"backend\": \"JNI\",");
+        System.out.println(String.format("  \"runtime\": \"%s %s\",",
+            System.getProperty("java.vm.name"), System.getProperty("java.version")));
+        System.out.println(String.format("  \"platform\": \"%s-%s\",",
+            System.getProperty("os.name").toLowerCase(Locale.ROOT), System.getProperty("os.arch")));
+        System.out.println("  \"results\": [");
+        System.out.println(results);
+        System.out.println("  ]");
+        System.out.println("}");
+        if (sink == 0)
+            System.err.println("Unexpected sink value");
+    }
+}
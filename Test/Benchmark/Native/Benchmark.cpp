@@ -0,0 +1,105 @@
+﻿/**
+ * SPDX-FileCopyrightText: (C) 2020 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: MIT-0
+ */
+
+// Native side of the interop micro-benchmarks. Each method does the
+// least possible work so timings are dominated by the marshaling
+// performed by the generated trampolines
+
+#include <Benchmark.ipp>
+#include <cstring>
+
+namespace
+{
+    constexpr size_t MaxStringLength = 4096;
+
+    const char* getChars()
+    {
+        static char s_chars[MaxStringLength + 1] = { };
+        if (s_chars[0] == '\0')
+            std::memset(s_chars, 'a', MaxStringLength);
+
+        return s_chars;
+    }
+}
+
+namespace benchmarklibrary
+{
+    void BBNoop()
+    {
+    }
+
+    int BBPassInt(int value)
+    {
+        return value;
+    }
+
+    int BBPassString(const cbstringp& value)
+    {
+        return (int)(*value).length();
+    }
+
+    cbstringr BBReturnString(int length)
+    {
+        if (length < 0 || (size_t)length > MaxStringLength)
+            return nullptr;
+
+        // Transient: the trampolines copy it before their scratch scope exits
+        return cb::ScratchString(getChars(), (size_t)length);
+    }
+
+    cbstringr BBReturnStringCached(int length)
+    {
+        return BBReturnString(length);
+    }
+
+    int BBReadArray(const uint8_t buffer[], int size)
+    {
+        // Touch the first and last element only: the copy, if any, is
+        // performed by the trampoline and is what is being measured
+        if (size == 0)
+            return 0;
+
+        return buffer[0] + buffer[size - 1];
+    }
+
+    int BBReadArrayCritical(const uint8_t buffer[], int size)
+    {
+        return BBReadArray(buffer, size);
+    }
+
+    void BBFillArray(int buffer[], int size)
+    {
+        if (size == 0)
+            return;
+
+        buffer[0] = size;
+        buffer[size - 1] = size;
+    }
+
+    void BBIncrementBox(int* value)
+    {
+        (*value)++;
+    }
+
+    cbbuffer BBReturnBuffer(int size)
+    {
+        auto ret = cb::CreateBuffer<uint8_t>((size_t)size);
+        std::memset(ret.data, 0, (size_t)size);
+        return ret;
+    }
+
+    cbstringarray BBReturnStringArray(int count)
+    {
+        constexpr size_t ItemLength = 16;
+        auto ret = CBCreateStringArrayFixed((size_t)count, (size_t)count * ItemLength);
+        if (ret.data == nullptr)
+            throw std::bad_alloc();
+
+        for (int i = 0; i < count; i++)
+            CBStringArraySet(&ret, (size_t)i, getChars(), ItemLength);
+
+        return ret;
+    }
+}
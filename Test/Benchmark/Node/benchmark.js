@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: (C) 2020 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: MIT-0
+
+// NAPI interop micro-benchmarks. The generated addon is loaded directly,
+// bypassing the TypeScript wrappers, so only the trampolines are measured.
+// Usage: node benchmark.js <path to BenchmarkLibrary.node> [iterations]
+
+'use strict';
+
+const path = require('path');
+const proc = require('process');
+
+const addonPath = path.resolve(proc.argv[2]);
+const iterations = proc.argv.length > 3 ? parseInt(proc.argv[3]) : 1000000;
+const mod = { exports: {} };
+proc.dlopen(mod, addonPath);
+const napi = mod.exports({});
+
+const results = [];
+
+function run(name, primitive, size, iters, fn)
+{
+    // Warm up, to let the JIT settle
+    const warmup = Math.max(1, iters / 10);
+    for (let i = 0; i < warmup; i++)
+        fn();
+
+    const start = proc.hrtime.bigint();
+    for (let i = 0; i < iters; i++)
+        fn();
+
+    const elapsed = Number(proc.hrtime.bigint() - start);
+    results.push({
+        name: name,
+        primitive: primitive,
+        size: size,
+        iterations: iters,
+        ns_per_call: elapsed / iters
+    });
+}
+
+const str16 = 'a'.repeat(16);
+const str1024 = 'a'.repeat(1024);
+const bytes16 = new Uint8Array(16);
+const bytes4096 = new Uint8Array(4096);
+const ints16 = new Int32Array(16);
+const ints4096 = new Int32Array(4096);
+const box = { value: 0 };
+
+run('noop', 'call', 0, iterations, () => napi.BBNoop());
+run('pass_int', 'call', 0, iterations, () => napi.BBPassInt(42));
+run('pass_string', 'string_in', 16, iterations, () => napi.BBPassString(str16));
+run('pass_string', 'string_in', 1024, iterations, () => napi.BBPassString(str1024));
+run('return_string', 'string_out', 16, iterations, () => napi.BBReturnString(16));
+run('return_string', 'string_out', 1024, iterations, () => napi.BBReturnString(1024));
+run('read_array', 'array_in', 16, iterations, () => napi.BBReadArray(bytes16, bytes16.length));
+run('read_array', 'array_in', 4096, iterations, () => napi.BBReadArray(bytes4096, bytes4096.length));
+run('fill_array', 'array_out', 16, iterations, () => napi.BBFillArray(ints16, ints16.length));
+run('fill_array', 'array_out', 4096, iterations, () => napi.BBFillArray(ints4096, ints4096.length));
+run('increment_box', 'box_inout', 0, iterations, () => napi.BBIncrementBox(box));
+run('return_buffer', 'buffer_out', 16, iterations, () => napi.BBReturnBuffer(16));
+run('return_buffer', 'buffer_out', 4096, iterations / 10, () => napi.BBReturnBuffer(4096));
+run('return_string_array', 'string_array_out', 16, iterations / 10, () => napi.BBReturnStringArray(16));
+
+console.log(JSON.stringify({
+    backend: 'NAPI',
+    runtime: `node ${proc.version}`,
+    platform: `${proc.platform}-${proc.arch}`,
+    results: results
+}, null, 2));
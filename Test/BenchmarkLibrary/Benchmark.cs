@@ -0,0 +1,103 @@
+﻿// Tag the library
+[assembly: NativeLibrary("BenchmarkLibrary")]
+
+namespace BenchmarkLibrary;
+
+/// <summary>
+/// Minimal native methods, each exercising a single marshaling
+/// primitive, used to measure the cost of a boundary crossing
+/// </summary>
+[Module("Benchmark")]
+public class Benchmark
+{
+    public static void Noop()
+    {
+        BBNoop();
+    }
+
+    public static int PassInt(int value)
+    {
+        return BBPassInt(value);
+    }
+
+    public static int PassString(string value)
+    {
+        return BBPassString(value);
+    }
+
+    public static string? ReturnString(int length)
+    {
+        return BBReturnString(length);
+    }
+
+    public static string? ReturnStringCached(int length)
+    {
+        return BBReturnStringCached(length);
+    }
+
+    public static int ReadArray(byte[] buffer)
+    {
+        return BBReadArray(buffer, buffer.Length);
+    }
+
+    public static int ReadArrayCritical(byte[] buffer)
+    {
+        return BBReadArrayCritical(buffer, buffer.Length);
+    }
+
+    public static void FillArray(int[] buffer)
+    {
+        BBFillArray(buffer, buffer.Length);
+    }
+
+    [Requires(Features.PassByRef)]
+    public static void IncrementBox(ref int value)
+    {
+        BBIncrementBox(ref value);
+    }
+
+    public static byte[]? ReturnBuffer(int size)
+    {
+        return BBReturnBuffer(size);
+    }
+
+    public static string[]? ReturnStringArray(int count)
+    {
+        return BBReturnStringArray(count);
+    }
+
+    [DllImport("BenchmarkLibrary", CallingConvention = CallingConvention.Cdecl), Order]
+    static extern void BBNoop();
+
+    [DllImport("BenchmarkLibrary", CallingConvention = CallingConvention.Cdecl), Order]
+    static extern int BBPassInt(int value);
+
+    [DllImport("BenchmarkLibrary", CallingConvention = CallingConvention.Cdecl), Order]
+    static extern int BBPassString(cbstring value);
+
+    [DllImport("BenchmarkLibrary", CallingConvention = CallingConvention.Cdecl), Order]
+    static extern cbstring BBReturnString(int length);
+
+    [DllImport("BenchmarkLibrary", CallingConvention = CallingConvention.Cdecl), Order, CachedString]
+    static extern cbstring BBReturnStringCached(int length);
+
+    [DllImport("BenchmarkLibrary", CallingConvention = CallingConvention.Cdecl), Order]
+    static extern int BBReadArray([In] byte[] buffer, int size);
+
+    [DllImport("BenchmarkLibrary", CallingConvention = CallingConvention.Cdecl), Order, CriticalArray]
+    static extern int BBReadArrayCritical([In] byte[] buffer, int size);
+
+    [DllImport("BenchmarkLibrary", CallingConvention = CallingConvention.Cdecl), Order]
+    static extern void BBFillArray([Out] int[] buffer, int size);
+
+    // Internal so hosts lacking pass by reference, eg. Java, can still
+    // reach it from the benchmark runners
+    [DllImport("BenchmarkLibrary", CallingConvention = CallingConvention.Cdecl), Order]
+    internal static extern void BBIncrementBox(ref int value);
+
+    [DllImport("BenchmarkLibrary", CallingConvention = CallingConvention.Cdecl), Order]
+    static extern cbbuffer BBReturnBuffer(int size);
+
+    [DllImport("BenchmarkLibrary", CallingConvention = CallingConvention.Cdecl), Order]
+    static extern cbstringarray BBReturnStringArray(int count);
+}
@@ -0,0 +1,4 @@
+﻿global using CodeBinder;
+global using CodeBinder.Attributes;
+global using System;
+global using System.Runtime.InteropServices;
@@ -6,6 +6,10 @@ public class Document : HandledObject<Document>
     PageCollection _pages;
     Metadata _metadata;
 
+    // Keep the delegate alive while it's bound natively
+    [Requires(Features.Delegates)]
+    ProgressCallback? _progress;
+
     static Document()
     {
         Common.InitLibrary();
@@ -60,8 +64,27 @@ public class Document : HandledObject<Document>
         return new Document(ptr);
     }
 
+    /// <summary>
+    /// Set the callback reporting the progress of long running operations,
+    /// which may be invoked from a native worker thread
+    /// </summary>
+    [Requires(Features.Delegates)]
+    public void SetProgressCallback(ProgressCallback? callback)
+    {
+        _progress = callback;
+        SLDocSetProgressCallback(Handle, callback);
+    }
+
     #endregion // Methods
 
+    #region Delegates
+
+    [Requires(Features.Delegates)]
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl), NativeBinding("SLProgressCallback")]
+    public delegate void ProgressCallback(int current, int total, cbstring message);
+
+    #endregion // Delegates
+
     #region Properties
 
     public PageCollection Pages
@@ -78,7 +101,7 @@ public class Document : HandledObject<Document>
 
     #region DllImport
 
-    [DllImport("SampleLibrary", CallingConvention = CallingConvention.Cdecl), Order]
+    [DllImport("SampleLibrary", CallingConvention = CallingConvention.Cdecl), Order, BatchedRelease, BackgroundRelease]
     static extern void SLFreeDocument([SLDocument] IntPtr doc);
 
     [DllImport("SampleLibrary", CallingConvention = CallingConvention.Cdecl), Order]
@@ -89,7 +112,7 @@ public class Document : HandledObject<Document>
     [return: SLDocument]
     static extern IntPtr SLPdfLoadBuffer([In] byte[] buffer, int offset, int size, cbstring password);
 
-    [DllImport("SampleLibrary", CallingConvention = CallingConvention.Cdecl), Order]
+    [DllImport("SampleLibrary", CallingConvention = CallingConvention.Cdecl), Order, Async]
     [return: SLDocument]
     static extern IntPtr SLPdfLoadFile(cbstring filename, cbstring password);
 
@@ -101,6 +124,9 @@ public class Document : HandledObject<Document>
     [return: MarshalAs(UnmanagedType.I1)]
     static extern cbbool SLIsPdfDocumentBuffer([In] byte[] buffer, int size, out DocVersion version);
 
+    [DllImport("SampleLibrary", CallingConvention = CallingConvention.Cdecl), Order, Requires(Features.Delegates)]
+    static extern void SLDocSetProgressCallback([SLDocument] HandleRef doc, ProgressCallback? callback);
+
     #endregion // DllImport
 }
 
@@ -176,7 +202,7 @@ public partial class PageCollection : IEnumerable<Page>
     [DllImport("SampleLibrary", CallingConvention = CallingConvention.Cdecl), Order]
     static extern int SLDocGetPageCount([SLDocument] HandleRef doc);
 
-    [DllImport("SampleLibrary", CallingConvention = CallingConvention.Cdecl), Order]
+    [DllImport("SampleLibrary", CallingConvention = CallingConvention.Cdecl), Order, Async]
     static extern void SLDocGetPages([SLDocument] HandleRef doc, [SLPdfPage][Out] IntPtr[] pages);
 
     [DllImport("SampleLibrary", CallingConvention = CallingConvention.Cdecl), Order]
@@ -217,11 +243,27 @@ public class Metadata
         get { return SLDocGetVersion(_doc.Handle); }
     }
 
+    public byte[]? XmpMetadata
+    {
+        get { return SLDocGetXmpMetadata(_doc.Handle); }
+    }
+
+    public string[]? FontNames
+    {
+        get { return SLDocGetFontNames(_doc.Handle); }
+    }
+
     [DllImport("SampleLibrary", CallingConvention = CallingConvention.Cdecl), Order]
     static extern DocVersion SLDocGetVersion([SLDocument] HandleRef doc);
 
     [DllImport("SampleLibrary", CallingConvention = CallingConvention.Cdecl), Order]
     static extern cbstring SLDocGetTitle([SLDocument] HandleRef doc);
+
+    [DllImport("SampleLibrary", CallingConvention = CallingConvention.Cdecl), Order]
+    static extern cbbuffer SLDocGetXmpMetadata([SLDocument] HandleRef doc);
+
+    [DllImport("SampleLibrary", CallingConvention = CallingConvention.Cdecl), Order]
+    static extern cbstringarray SLDocGetFontNames([SLDocument] HandleRef doc);
 }
 
 #endregion // Support
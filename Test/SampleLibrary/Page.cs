@@ -5,6 +5,7 @@
 public class Page : HandledObject<Page>
 {
     PageAnnotationCollection _annotations;
+    HandledObjectCache<Annotation> _annotationCache;
 
     public Document Document { get; private set; }
 
@@ -12,6 +13,7 @@ public class Page : HandledObject<Page>
         : base(page, false)
     {
         _annotations = new PageAnnotationCollection(this);
+        _annotationCache = new HandledObjectCache<Annotation>();
         Document = doc;
     }
 
@@ -30,7 +32,14 @@ public class Page : HandledObject<Page>
         for (int i = 0; i < annotPtrs.Length; i++)
         {
             var annotPtr = annotPtrs[i];
-            var annot = Annotation.CreateAnnotation(annotPtr, this);
+            // Reuse the live wrapper, if any, so repeated lookups preserve identity
+            var annot = _annotationCache.Get(annotPtr);
+            if (annot == null)
+            {
+                annot = Annotation.CreateAnnotation(annotPtr, this);
+                _annotationCache.Add(annot);
+            }
+
             if (predicate.P(annot))
                 annotations.Add((TAnnotation)annot);
         }
@@ -0,0 +1,106 @@
+#!/usr/bin/env pwsh
+
+# Cross-backend interop micro-benchmarks: generate the BenchmarkLibrary
+# bindings, build the native libraries and run the JNI, NAPI and .NET
+# P/Invoke drivers, merging their results in a single JSON file.
+# Requires a C++17 compiler (g++ by default, override with CXX), a JDK
+# (JAVA_HOME must be set) and node. Linux only for now
+
+param(
+    [int]$Iterations = 1000000,
+    [string]$Output = "benchmark-results.json"
+)
+
+$ErrorActionPreference = "Stop"
+
+function Invoke-Checked
+{
+    param([string]$Command, [string[]]$Arguments)
+    & $Command @Arguments
+    if ($LASTEXITCODE -ne 0) { throw "Command failed: $Command $Arguments" }
+}
+
+$conf="Release"
+Invoke-Checked dotnet build, CodeBinder.sln, --configuration, $conf, /p:Platform="Any CPU"
+
+# This is needed as per https://github.com/dotnet/roslyn/issues/52293
+Invoke-Checked dotnet restore, "$((Join-Path Test CodeBinder.Test.sln))"
+
+$codebinder = Join-Path bin $conf $(if ($IsWindows) { "CodeBinder.exe" } else { "CodeBinder" })
+$targetpath = Join-Path .. CodeBinder-Benchmark
+$solution = "--solution=$((Join-Path Test CodeBinder.Test.sln))"
+
+$clang = Join-Path $targetpath BenchmarkLibraryCLang
+$jni = Join-Path $targetpath BenchmarkLibraryJNI
+$jdk = Join-Path $targetpath BenchmarkLibraryJDK
+$napi = Join-Path $targetpath BenchmarkLibraryNAPI
+$naot = Join-Path $targetpath BenchmarkLibraryNAOT
+$outdir = Join-Path $targetpath out
+
+# CLang
+Invoke-Checked $codebinder $solution, --project=BenchmarkLibrary, --language=CLang, "--targetpath=$clang"
+
+# Java JNI
+Invoke-Checked $codebinder $solution, --project=BenchmarkLibrary, `
+    --language=JNI, --nsmapping=BenchmarkLibrary:BenchmarkLibrary, "--targetpath=$jni"
+
+# Java JDK
+Invoke-Checked $codebinder $solution, --project=BenchmarkLibrary, `
+    --language=Java, --nsmapping=BenchmarkLibrary:BenchmarkLibrary, "--targetpath=$jdk"
+
+# NodeJS NAPI
+Invoke-Checked $codebinder $solution, --project=BenchmarkLibrary, --language=NAPI, "--targetpath=$napi"
+
+# EXPERIMENTAL: NativeAOT. Generated to check the bindings, .NET is
+# measured through the P/Invoke declarations of BenchmarkLibrary
+Invoke-Checked $codebinder $solution, --project=BenchmarkLibrary, --language=NAOT, "--targetpath=$naot"
+
+New-Item -ItemType Directory -Force -Path $outdir | Out-Null
+
+$cxx = if ($env:CXX) { $env:CXX } else { "g++" }
+$cxxflags = @("-O2", "-std=c++17", "-shared", "-fPIC", "-DBENCHMARKLIBRARY_EXPORT", "-I$clang")
+$native = Join-Path Test Benchmark Native Benchmark.cpp
+
+# Plain library, loaded by .NET
+$plainlib = Join-Path $outdir libBenchmarkLibrary.so
+Invoke-Checked $cxx ($cxxflags + @($native, "-o", $plainlib))
+
+# JNI library
+$jnilib = Join-Path $outdir libBenchmarkLibraryJNI.so
+$jnisources = Get-ChildItem -Recurse -Path $jni -Filter *.cpp | ForEach-Object { $_.FullName }
+Invoke-Checked $cxx ($cxxflags + @("-I$jni", "-I$(Join-Path $env:JAVA_HOME include)",
+    "-I$(Join-Path $env:JAVA_HOME include linux)", $native) + $jnisources + @("-o", $jnilib))
+
+# NAPI addon
+$napilib = Join-Path $outdir BenchmarkLibrary.node
+$napisources = Get-ChildItem -Recurse -Path $napi -Filter *.cpp | ForEach-Object { $_.FullName }
+Invoke-Checked $cxx ($cxxflags + @("-I$napi", $native) + $napisources + @("-o", $napilib))
+
+$results = @()
+
+# JNI
+$classes = Join-Path $outdir classes
+$javasources = @(Get-ChildItem -Recurse -Path $jdk -Filter *.java | ForEach-Object { $_.FullName })
+$javasources += Join-Path Test Benchmark Java BenchmarkRunner.java
+Invoke-Checked javac (@("-d", $classes) + $javasources)
+$results += (& java -cp $classes BenchmarkLibrary.BenchmarkRunner $jnilib $Iterations | Out-String | ConvertFrom-Json)
+if ($LASTEXITCODE -ne 0) { throw "JNI benchmark failed" }
+
+# NAPI
+$results += (& node (Join-Path Test Benchmark Node benchmark.js) $napilib $Iterations | Out-String | ConvertFrom-Json)
+if ($LASTEXITCODE -ne 0) { throw "NAPI benchmark failed" }
+
+# .NET P/Invoke, including the Redist string, buffer and string array conversions
+$runner = Join-Path Test Benchmark DotNet BenchmarkRunner.csproj
+Invoke-Checked dotnet build, $runner, --configuration, $conf
+$results += (& dotnet run --no-build --project $runner --configuration $conf -- $plainlib $Iterations | Out-String | ConvertFrom-Json)
+if ($LASTEXITCODE -ne 0) { throw ".NET benchmark failed" }
+
+$report = [ordered]@{
+    commit = (git rev-parse HEAD)
+    date = (Get-Date -Format o)
+    iterations = $Iterations
+    backends = $results
+}
+$report | ConvertTo-Json -Depth 5 | Set-Content -Path $Output
+Write-Host "Results written to $Output"